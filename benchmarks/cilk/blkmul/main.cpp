@@ -4,7 +4,6 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 #include <cstring>
@@ -12,8 +11,9 @@
 #include <cilk/cilk.h>
 #include <cilk/cilk_api.h> 
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 inline uint32_t xorshift_rand() {
 	static uint32_t x = 2463534242;
@@ -294,22 +294,16 @@ void test(Block *A, Block *B, Block *C, size_t n)
 
 int main(int argc, char *argv[])
 {
-	size_t log_n = 4;
-	const char *nthreads = nullptr;
+	harness::benchmark bench("cilk", "blkmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = argv[1];
-	if (argc >= 3)
-		log_n = atoi(argv[2]);
-	if (nthreads == nullptr)
-		nthreads = to_string(thread::hardware_concurrency()).c_str();
+	size_t log_n = bench.arg(0, 4);
 
 	auto n = 1 << log_n;
 
-	cout << "Matrix dim: " << n * 16 << "\n";
+	cerr << "Matrix dim: " << n * 16 << "\n";
 	auto nblocks = n * n;
 
-	cout << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
+	cerr << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
 
 	auto A = new Block[nblocks];
 	auto B = new Block[nblocks];
@@ -318,33 +312,33 @@ int main(int argc, char *argv[])
 	fill(A, nblocks);
 	fill(B, nblocks);
 
-	__cilkrts_end_cilk(); 
+	bench.input(to_string(log_n));
 
-	auto start = system_clock::now();
+	auto nthreads = to_string(bench.nthreads());
 
-	if (__cilkrts_set_param("nworkers", nthreads) != 0) {
-		cerr << "Failed to set worker count\n";
-		exit(EXIT_FAILURE);
-	}
+	__cilkrts_end_cilk();
 
-	__cilkrts_init();
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
 
-	test(A, B, R, nblocks);
+		if (__cilkrts_set_param("nworkers", nthreads.c_str()) != 0) {
+			cerr << "Failed to set worker count\n";
+			exit(EXIT_FAILURE);
+		}
 
-	__cilkrts_end_cilk(); 
+		__cilkrts_init();
 
-	auto stop = system_clock::now();
+		b.start_compute();
+		test(A, B, R, nblocks);
+		b.stop_compute();
 
-	cout << "Scheduler:  cilk\n";
-	cout << "Benchmark:  blkmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << log_n << "\n";
-	cout << "Output:     " << check(A, B, R, nblocks) << "\n";
+		__cilkrts_end_cilk();
+	});
+
+	bench.report(to_string(check(A, B, R, nblocks)));
 
 	delete []A;
 	delete []B;
 	delete []R;
 	return 0;
 }
-
@@ -1,13 +1,13 @@
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <thread>
 
 #include <cilk/cilk.h>
 #include <cilk/cilk_api.h> 
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 void dfs(size_t depth, size_t breadth, unsigned long *sum) {
 	if (depth == 0) {
@@ -35,43 +35,36 @@ void test(size_t depth, size_t breadth, unsigned long *sum)
 
 int main(int argc, char *argv[])
 {
-	size_t depth = 8;
-	size_t breadth = 8;
+	harness::benchmark bench("cilk", "dfs", argc, argv);
+
+	size_t depth = bench.arg(0, 8);
+	size_t breadth = bench.arg(1, 8);
 	unsigned long answer;
-	const char *nthreads = nullptr;
 
-	if (argc >= 2)
-		nthreads = argv[1];
-	if (argc >= 3)
-		depth = atoi(argv[2]);
-	if (argc >= 4)
-		breadth = atoi(argv[3]);
-	if (nthreads == nullptr)
-		nthreads = to_string(thread::hardware_concurrency()).c_str();
+	bench.input(to_string(depth) + " " + to_string(breadth));
 
-	__cilkrts_end_cilk(); 
+	auto nthreads = to_string(bench.nthreads());
 
-	auto start = system_clock::now();
+	__cilkrts_end_cilk();
 
-	if (__cilkrts_set_param("nworkers", nthreads) != 0) {
-		cerr << "Failed to set worker count\n";
-		exit(EXIT_FAILURE);
-	}
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
 
-	__cilkrts_init();
+		if (__cilkrts_set_param("nworkers", nthreads.c_str()) != 0) {
+			cerr << "Failed to set worker count\n";
+			exit(EXIT_FAILURE);
+		}
 
-	test(depth, breadth, &answer);
+		__cilkrts_init();
 
-	__cilkrts_end_cilk(); 
+		b.start_compute();
+		test(depth, breadth, &answer);
+		b.stop_compute();
 
-	auto stop = system_clock::now();
+		__cilkrts_end_cilk();
+	});
 
-	cout << "Scheduler:  cilk\n";
-	cout << "Benchmark:  dfs\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << depth << " " << breadth << "\n";
-	cout << "Output:     " << answer << "\n";
+	bench.report(to_string(answer));
 
 	return 0;
 }
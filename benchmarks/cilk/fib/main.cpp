@@ -1,10 +1,11 @@
 #include <iostream>
-#include <chrono>
 #include <thread>
 
 #include <cilk/cilk.h>
 #include <cilk/cilk_api.h> 
 
+#include "../../harness.hpp"
+
 using namespace std;
 using namespace std::chrono;
 
@@ -34,40 +35,35 @@ void test(int n, unsigned long *sum)
 
 int main(int argc, char *argv[])
 {
-	size_t n = 40;
+	harness::benchmark bench("cilk", "fib", argc, argv);
+
+	int n = bench.arg(0, 40);
 	unsigned long answer;
-	const char *nthreads = nullptr;
 
-	if (argc >= 2)
-		nthreads = argv[1];
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == nullptr)
-		nthreads = to_string(thread::hardware_concurrency()).c_str();
+	bench.input(to_string(n));
 
-	__cilkrts_end_cilk(); 
+	auto nthreads = to_string(bench.nthreads());
 
-	auto start = system_clock::now();
+	__cilkrts_end_cilk();
 
-	if (__cilkrts_set_param("nworkers", nthreads) != 0) {
-		cerr << "Failed to set worker count\n";
-		exit(EXIT_FAILURE);
-	}
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
 
-	__cilkrts_init();
+		if (__cilkrts_set_param("nworkers", nthreads.c_str()) != 0) {
+			cerr << "Failed to set worker count\n";
+			exit(EXIT_FAILURE);
+		}
 
-	test(n, &answer);
+		__cilkrts_init();
 
-	__cilkrts_end_cilk(); 
+		b.start_compute();
+		test(n, &answer);
+		b.stop_compute();
 
-	auto stop = system_clock::now();
+		__cilkrts_end_cilk();
+	});
 
-	cout << "Scheduler:  cilk\n";
-	cout << "Benchmark:  fib\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << answer << "\n";
+	bench.report(to_string(answer));
 
 	return 0;
 }
@@ -12,15 +12,15 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 
 #include <cilk/cilk.h>
 #include <cilk/cilk_api.h> 
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 typedef float elem_t;
 
@@ -139,17 +139,12 @@ void test(
 	cilk_sync;
 }
 
-int main(int argc, char *argv[]) {
-	elem_t *A, *B, *C;
-	size_t n = 3000;
-	const char *nthreads = nullptr;
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("cilk", "matmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = argv[1];
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = to_string(thread::hardware_concurrency()).c_str();
+	elem_t *A, *B, *C;
+	size_t n = bench.arg(0, 3000);
 
 	A = new elem_t[n * n];
 	B = new elem_t[n * n];
@@ -157,34 +152,36 @@ int main(int argc, char *argv[]) {
 
 	fill(A, n);
 	fill(B, n);
-	zero(C, n);
 
-	__cilkrts_end_cilk(); 
+	bench.input(to_string(n));
 
-	auto start = system_clock::now();
+	auto nthreads = to_string(bench.nthreads());
 
-	if (__cilkrts_set_param("nworkers", nthreads) != 0) {
-		cerr << "Failed to set worker count\n";
-		exit(EXIT_FAILURE);
-	}
+	__cilkrts_end_cilk();
+
+	bench.run([&](harness::benchmark &b) {
+		zero(C, n);
 
-	__cilkrts_init();
+		b.start_scheduler();
+
+		if (__cilkrts_set_param("nworkers", nthreads.c_str()) != 0) {
+			cerr << "Failed to set worker count\n";
+			exit(EXIT_FAILURE);
+		}
 
-	test(A, B, C, n);
+		__cilkrts_init();
 
-	__cilkrts_end_cilk(); 
+		b.start_compute();
+		test(A, B, C, n);
+		b.stop_compute();
 
-	auto stop = system_clock::now();
+		__cilkrts_end_cilk();
+	});
 
-	cout << "Scheduler:  cilk\n";
-	cout << "Benchmark:  matmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check(A, B, C, n) << "\n";
+	bench.report(to_string(check(A, B, C, n)));
 
 	delete []C;
 	delete []B;
-	delete []A; 
+	delete []A;
 	return 0;
 }
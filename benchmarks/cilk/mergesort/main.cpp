@@ -1,13 +1,14 @@
 #include <iostream>
-#include <chrono>
+#include <vector>
 #include <thread>
 #include <cstring>
 
 #include <cilk/cilk.h>
 #include <cilk/cilk_api.h> 
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 typedef int elem_t;
 
@@ -95,41 +96,39 @@ void test(size_t left, size_t right)
 
 int main(int argc, char *argv[])
 {
-	size_t n = 8e7;
-	const char *nthreads = nullptr;
+	harness::benchmark bench("cilk", "mergesort", argc, argv);
 
-	if (argc >= 2)
-		nthreads = argv[1];
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = to_string(thread::hardware_concurrency()).c_str();
+	size_t n = bench.arg(0, 8e7);
 
 	generate_data(n);
+	vector<elem_t> input(data, data + n);
 
-	__cilkrts_end_cilk(); 
+	bench.input(to_string(n));
 
-	auto start = system_clock::now();
+	auto nthreads = to_string(bench.nthreads());
 
-	if (__cilkrts_set_param("nworkers", nthreads) != 0) {
-		cerr << "Failed to set worker count\n";
-		exit(EXIT_FAILURE);
-	}
+	__cilkrts_end_cilk();
+
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
 
-	__cilkrts_init();
+		b.start_scheduler();
+
+		if (__cilkrts_set_param("nworkers", nthreads.c_str()) != 0) {
+			cerr << "Failed to set worker count\n";
+			exit(EXIT_FAILURE);
+		}
 
-	test(0, n);
+		__cilkrts_init();
 
-	__cilkrts_end_cilk(); 
+		b.start_compute();
+		test(0, n);
+		b.stop_compute();
 
-	auto stop = system_clock::now();
+		__cilkrts_end_cilk();
+	});
 
-	cout << "Scheduler:  cilk\n";
-	cout << "Benchmark:  mergesort\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check() << "\n";
+	bench.report(to_string(check()));
 
 	return 0;
 }
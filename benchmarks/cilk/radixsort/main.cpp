@@ -0,0 +1,153 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cstring>
+
+#include <cilk/cilk.h>
+#include <cilk/cilk_api.h> 
+
+#include "../../harness.hpp"
+
+using namespace std;
+
+#define FOR_BLOCKS(k, n) \
+	cilk_for (size_t k = 0; k < n; ++k)
+#define FOR_BLOCKS_END
+
+typedef uint64_t elem_t;
+
+size_t lenght = 0;
+elem_t *data = nullptr;
+elem_t sum_before = 0;
+
+inline uint64_t xorshift_rand() {
+	static uint64_t x = 88172645463325252ull;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	return x * 2685821657736338717ull;
+}
+
+void generate_data(size_t n) {
+	lenght = n;
+	data = new elem_t[n];
+	sum_before = 0;
+	for (size_t i = 0; i < n; ++i) {
+		data[i] = xorshift_rand();
+		sum_before += data[i];
+	}
+}
+
+bool check() {
+	elem_t s = data[0];
+	for (size_t i = 1; i < lenght; ++i) {
+		s += data[i];
+		if (data[i - 1] > data[i])
+			return false;
+	}
+
+	return sum_before == s;
+}
+
+static const unsigned radix_bits = 8;
+static const size_t radix_buckets = 1 << radix_bits;
+static const unsigned npasses = sizeof(elem_t) * 8 / radix_bits;
+
+inline size_t digit(elem_t x, unsigned pass) {
+	return (x >> (pass * radix_bits)) & (radix_buckets - 1);
+}
+
+// Every pass counts digits of each block, computes block offsets serially
+// and then lets every block scatter its elements independently.
+void radixsort(elem_t *a, size_t n, size_t nblocks) {
+	size_t block = (n + nblocks - 1) / nblocks;
+	size_t *counts = new size_t[nblocks * radix_buckets];
+
+	elem_t *tmp = new elem_t[n];
+	elem_t *src = a;
+	elem_t *dst = tmp;
+
+	for (unsigned p = 0; p < npasses; ++p) {
+		FOR_BLOCKS(k, nblocks) {
+			size_t *c = counts + k * radix_buckets;
+			size_t e = min(n, (k + 1) * block);
+			fill(c, c + radix_buckets, 0);
+			for (size_t i = k * block; i < e; ++i)
+				c[digit(src[i], p)]++;
+		}
+		FOR_BLOCKS_END
+
+		size_t s = 0;
+		bool trivial = false;
+		for (size_t b = 0; b < radix_buckets; ++b) {
+			size_t t = s;
+			for (size_t k = 0; k < nblocks; ++k) {
+				size_t &c = counts[k * radix_buckets + b];
+				size_t x = c;
+				c = s;
+				s += x;
+			}
+			if (s - t == n)
+				trivial = true;
+		}
+
+		if (trivial)
+			continue;
+
+		FOR_BLOCKS(k, nblocks) {
+			size_t *off = counts + k * radix_buckets;
+			size_t e = min(n, (k + 1) * block);
+			for (size_t i = k * block; i < e; ++i)
+				dst[off[digit(src[i], p)]++] = src[i];
+		}
+		FOR_BLOCKS_END
+
+		swap(src, dst);
+	}
+
+	if (src != a)
+		memcpy(a, src, n * sizeof(elem_t));
+
+	delete []tmp;
+	delete []counts;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("cilk", "radixsort", argc, argv);
+
+	size_t n = bench.arg(0, 1e8);
+
+	generate_data(n);
+	vector<elem_t> input(data, data + n);
+
+	bench.input(to_string(n));
+
+	auto nthreads = to_string(bench.nthreads());
+
+	__cilkrts_end_cilk();
+
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
+
+		b.start_scheduler();
+
+		if (__cilkrts_set_param("nworkers", nthreads.c_str()) != 0) {
+			cerr << "Failed to set worker count\n";
+			exit(EXIT_FAILURE);
+		}
+
+		__cilkrts_init();
+
+		b.start_compute();
+		radixsort(data, n, __cilkrts_get_nworkers());
+		b.stop_compute();
+
+		__cilkrts_end_cilk();
+	});
+
+	bench.report(to_string(check()));
+
+	delete []data;
+	return 0;
+}
@@ -0,0 +1,331 @@
+#ifndef HARNESS_HPP_W5TB8KQC
+#define HARNESS_HPP_W5TB8KQC
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Common driver of the benchmarks of all schedulers. Every binary takes
+//     [-w warmups] [-r runs] [-f text|csv|json] [threads [args...]]
+// and runs its workload warmups + runs times. The benchmark marks three
+// phases of a run: scheduler startup, compute and teardown, which is
+// everything after compute, e.g. the scheduler's destructor. Work done
+// before startup, such as resetting the input, isn't measured. Times are
+// in microseconds.
+namespace harness
+{
+
+struct summary
+{
+	double median;
+	double mean;
+	double stddev;
+
+	// 95% confidence interval of the mean
+	double ci_low;
+	double ci_high;
+};
+
+inline summary summarize(std::vector<double> v)
+{
+	// Two-sided 95% quantiles of Student's t distribution
+	static const double t95[] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+		2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+		2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+	};
+
+	summary s = summary();
+	auto n = v.size();
+	if (n == 0)
+		return s;
+
+	std::sort(v.begin(), v.end());
+	s.median = n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+
+	for (auto x : v)
+		s.mean += x;
+	s.mean /= n;
+
+	if (n > 1) {
+		for (auto x : v)
+			s.stddev += (x - s.mean) * (x - s.mean);
+		s.stddev = std::sqrt(s.stddev / (n - 1));
+	}
+
+	auto t = n - 1 <= 30 ? t95[n > 1 ? n - 2 : 0] : 1.96;
+	auto h = n > 1 ? t * s.stddev / std::sqrt(double(n)) : 0;
+
+	s.ci_low = s.mean - h;
+	s.ci_high = s.mean + h;
+	return s;
+}
+
+class benchmark
+{
+public:
+	benchmark(const char *sched, const char *name, int argc, char *argv[]);
+
+	size_t nthreads() const;
+
+	// i-th argument after the thread count, or def if there is none
+	size_t arg(size_t i, size_t def) const;
+
+	// Printed along with the times
+	void input(const std::string &s);
+
+	// Calls f(*this) for every run
+	template <typename F>
+	void run(F f);
+
+	// Prints the times of the runs. The output is usually the result
+	// check of the last run.
+	void report(const std::string &output);
+
+	void start_scheduler();
+	void start_compute();
+	void stop_compute();
+
+private:
+	typedef std::chrono::steady_clock clock;
+
+	struct sample
+	{
+		double startup;
+		double compute;
+		double teardown;
+	};
+
+	static double us(clock::time_point from, clock::time_point to);
+
+	void usage(const char *bin) const;
+
+	void print_text() const;
+	void print_csv() const;
+	void print_json() const;
+
+	std::vector<double> phase(double sample::*p) const;
+
+	const char *m_sched;
+	const char *m_name;
+
+	size_t m_warmups;
+	size_t m_runs;
+	std::string m_format;
+
+	size_t m_nthreads;
+	std::vector<std::string> m_args;
+
+	std::string m_input;
+	std::string m_output;
+
+	bool m_started;
+	clock::time_point m_startup;
+	clock::time_point m_compute;
+	clock::time_point m_computed;
+
+	std::vector<sample> m_samples;
+};
+
+benchmark::benchmark(const char *sched, const char *name, int argc, char *argv[])
+: m_sched(sched)
+, m_name(name)
+, m_warmups(1)
+, m_runs(5)
+, m_format("text")
+, m_nthreads(0)
+, m_started(false)
+{
+	int i = 1;
+	for (; i < argc && argv[i][0] == '-'; i += 2) {
+		if (i + 1 >= argc)
+			usage(argv[0]);
+
+		if (!strcmp(argv[i], "-w"))
+			m_warmups = atol(argv[i + 1]);
+		else if (!strcmp(argv[i], "-r"))
+			m_runs = atol(argv[i + 1]);
+		else if (!strcmp(argv[i], "-f"))
+			m_format = argv[i + 1];
+		else
+			usage(argv[0]);
+	}
+
+	if (m_runs == 0 || (m_format != "text" && m_format != "csv" && m_format != "json"))
+		usage(argv[0]);
+
+	if (i < argc)
+		m_nthreads = atol(argv[i++]);
+	if (m_nthreads == 0)
+		m_nthreads = std::thread::hardware_concurrency();
+
+	for (; i < argc; ++i)
+		m_args.push_back(argv[i]);
+}
+
+void benchmark::usage(const char *bin) const
+{
+	std::cerr << "Usage: " << bin
+		<< " [-w warmups] [-r runs] [-f text|csv|json] [threads [args...]]\n";
+	exit(EXIT_FAILURE);
+}
+
+size_t benchmark::nthreads() const
+{
+	return m_nthreads;
+}
+
+size_t benchmark::arg(size_t i, size_t def) const
+{
+	return i < m_args.size() ? strtoull(m_args[i].c_str(), nullptr, 10) : def;
+}
+
+void benchmark::input(const std::string &s)
+{
+	m_input = s;
+}
+
+
+template <typename F>
+void benchmark::run(F f)
+{
+	for (size_t i = 0; i < m_warmups + m_runs; ++i) {
+		m_started = false;
+		m_compute = m_computed = clock::time_point();
+
+		f(*this);
+
+		auto end = clock::now();
+
+		if (i < m_warmups)
+			continue;
+
+		sample s;
+		s.startup = m_started ? us(m_startup, m_compute) : 0;
+		s.compute = us(m_compute, m_computed);
+		s.teardown = us(m_computed, end);
+		m_samples.push_back(s);
+	}
+}
+
+void benchmark::report(const std::string &output)
+{
+	m_output = output;
+
+	if (m_format == "csv")
+		print_csv();
+	else if (m_format == "json")
+		print_json();
+	else
+		print_text();
+}
+
+void benchmark::start_scheduler()
+{
+	m_started = true;
+	m_startup = clock::now();
+}
+
+void benchmark::start_compute()
+{
+	m_compute = clock::now();
+}
+
+void benchmark::stop_compute()
+{
+	m_computed = clock::now();
+}
+
+double benchmark::us(clock::time_point from, clock::time_point to)
+{
+	return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+std::vector<double> benchmark::phase(double sample::*p) const
+{
+	std::vector<double> v;
+	for (auto &s : m_samples)
+		v.push_back(s.*p);
+	return v;
+}
+
+// Time(us) is the median, so scripts reading the old output still work
+void benchmark::print_text() const
+{
+	auto c = summarize(phase(&sample::compute));
+	auto s = summarize(phase(&sample::startup));
+	auto t = summarize(phase(&sample::teardown));
+
+	std::cout << "Scheduler:  " << m_sched << "\n";
+	std::cout << "Benchmark:  " << m_name << "\n";
+	std::cout << "Threads:    " << m_nthreads << "\n";
+	std::cout << "Time(us):   " << long(c.median) << "\n";
+	std::cout << "Input:      " << m_input << "\n";
+	std::cout << "Output:     " << m_output << "\n";
+	std::cout << "Runs:       " << m_runs << " (" << m_warmups << " warmup)\n";
+	std::cout << "Mean(us):   " << long(c.mean) << " +- " << long(c.stddev) << "\n";
+	std::cout << "CI95(us):   " << long(c.ci_low) << " " << long(c.ci_high) << "\n";
+	std::cout << "Startup(us):  " << long(s.median) << "\n";
+	std::cout << "Teardown(us): " << long(t.median) << "\n";
+}
+
+// One row per run, with a header
+void benchmark::print_csv() const
+{
+	std::cout.setf(std::ios::fixed, std::ios::floatfield);
+	std::cout.precision(1);
+
+	std::cout << "sched,name,threads,input,output,run,startup,time,teardown\n";
+
+	for (size_t i = 0; i < m_samples.size(); ++i) {
+		auto &s = m_samples[i];
+		std::cout << m_sched << "," << m_name << "," << m_nthreads << ",\""
+			<< m_input << "\",\"" << m_output << "\"," << i << ","
+			<< s.startup << "," << s.compute << "," << s.teardown << "\n";
+	}
+}
+
+void benchmark::print_json() const
+{
+	std::cout.setf(std::ios::fixed, std::ios::floatfield);
+	std::cout.precision(1);
+
+	auto print_summary = [](const char *name, const summary &s) {
+		std::cout << "  \"" << name << "\": {\"median\": " << s.median
+			<< ", \"mean\": " << s.mean
+			<< ", \"stddev\": " << s.stddev
+			<< ", \"ci95\": [" << s.ci_low << ", " << s.ci_high << "]},\n";
+	};
+
+	std::cout << "{\n";
+	std::cout << "  \"sched\": \"" << m_sched << "\",\n";
+	std::cout << "  \"name\": \"" << m_name << "\",\n";
+	std::cout << "  \"threads\": " << m_nthreads << ",\n";
+	std::cout << "  \"input\": \"" << m_input << "\",\n";
+	std::cout << "  \"output\": \"" << m_output << "\",\n";
+	std::cout << "  \"warmups\": " << m_warmups << ",\n";
+
+	print_summary("startup", summarize(phase(&sample::startup)));
+	print_summary("time", summarize(phase(&sample::compute)));
+	print_summary("teardown", summarize(phase(&sample::teardown)));
+
+	std::cout << "  \"runs\": [";
+	for (size_t i = 0; i < m_samples.size(); ++i) {
+		auto &s = m_samples[i];
+		std::cout << (i ? ",\n    " : "\n    ")
+			<< "{\"startup\": " << s.startup
+			<< ", \"time\": " << s.compute
+			<< ", \"teardown\": " << s.teardown << "}";
+	}
+	std::cout << "\n  ]\n}\n";
+}
+
+} /* harness */
+
+#endif /* end of include guard: HARNESS_HPP_W5TB8KQC */
@@ -1,5 +1,4 @@
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 #include <cstring>
@@ -7,6 +6,8 @@
 
 #include <omp.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
 using namespace std::chrono;
 
@@ -303,22 +304,16 @@ void test(Block *A, Block *B, Block *C, size_t n)
 
 int main(int argc, char *argv[])
 {
-	size_t log_n = 4;
-	size_t nthreads = 0;
+	harness::benchmark bench("openmp", "blkmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		log_n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t log_n = bench.arg(0, 4);
 
 	auto n = 1 << log_n;
 
-	cout << "Matrix dim: " << n * 16 << "\n";
+	cerr << "Matrix dim: " << n * 16 << "\n";
 	auto nblocks = n * n;
 
-	cout << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
+	cerr << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
 
 	auto A = new Block[nblocks];
 	auto B = new Block[nblocks];
@@ -327,23 +322,24 @@ int main(int argc, char *argv[])
 	fill(A, nblocks);
 	fill(B, nblocks);
 
-	auto start = system_clock::now();
+	bench.input(to_string(log_n));
 
 	omp_set_dynamic(0);
-	omp_set_num_threads(nthreads);
+	omp_set_num_threads(bench.nthreads());
+
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
 
 #pragma omp parallel shared(A, B, R, nblocks)
 #pragma omp single
-	test(A, B, R, nblocks);
-
-	auto stop = system_clock::now();
+		{
+			b.start_compute();
+			test(A, B, R, nblocks);
+			b.stop_compute();
+		}
+	});
 
-	cout << "Scheduler:  openmp\n";
-	cout << "Benchmark:  blkmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << log_n << "\n";
-	cout << "Output:     " << check(A, B, R, nblocks) << "\n";
+	bench.report(to_string(check(A, B, R, nblocks)));
 
 	delete []A;
 	delete []B;
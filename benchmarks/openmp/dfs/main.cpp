@@ -1,12 +1,12 @@
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <thread>
 
 #include <omp.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 void dfs(size_t depth, size_t breadth, unsigned long *sum) {
 	if (depth == 0) {
@@ -39,37 +39,30 @@ void test(size_t depth, size_t breadth, unsigned long *sum)
 
 int main(int argc, char *argv[])
 {
-	size_t depth = 8;
-	size_t breadth = 8;
-	unsigned long answer;
-	size_t nthreads = 0;
+	harness::benchmark bench("openmp", "dfs", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		depth = atoi(argv[2]);
-	if (argc >= 4)
-		breadth = atoi(argv[3]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t depth = bench.arg(0, 8);
+	size_t breadth = bench.arg(1, 8);
+	unsigned long answer;
 
-	auto start = system_clock::now();
+	bench.input(to_string(depth) + " " + to_string(breadth));
 
 	omp_set_dynamic(0);
-	omp_set_num_threads(nthreads);
+	omp_set_num_threads(bench.nthreads());
+
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
 
 #pragma omp parallel shared(depth, breadth, answer)
 #pragma omp single
-	test(depth, breadth, &answer);
-
-	auto stop = system_clock::now();
-
-	cout << "Scheduler:  omp\n";
-	cout << "Benchmark:  dfs\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << depth << " " << breadth << "\n";
-	cout << "Output:     " << answer << "\n";
+		{
+			b.start_compute();
+			test(depth, breadth, &answer);
+			b.stop_compute();
+		}
+	});
+
+	bench.report(to_string(answer));
 
 	return 0;
 }
@@ -1,9 +1,10 @@
 #include <iostream>
-#include <chrono>
 #include <thread>
 
 #include <omp.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
 using namespace std::chrono;
 
@@ -36,34 +37,29 @@ void test(int n, unsigned long *sum)
 
 int main(int argc, char *argv[])
 {
-	size_t n = 40;
-	unsigned long answer;
-	size_t nthreads = 0;
+	harness::benchmark bench("openmp", "fib", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	int n = bench.arg(0, 40);
+	unsigned long answer;
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
 	omp_set_dynamic(0);
-	omp_set_num_threads(nthreads);
+	omp_set_num_threads(bench.nthreads());
+
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
 
 #pragma omp parallel shared(n, answer)
 #pragma omp single
-	test(n, &answer);
-
-	auto stop = system_clock::now();
-
-	cout << "Scheduler:  omp\n";
-	cout << "Benchmark:  fib\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << answer << "\n";
+		{
+			b.start_compute();
+			test(n, &answer);
+			b.stop_compute();
+		}
+	});
+
+	bench.report(to_string(answer));
 
 	return 0;
 }
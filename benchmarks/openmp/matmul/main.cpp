@@ -12,14 +12,14 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 
 #include <omp.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 typedef float elem_t;
 
@@ -147,16 +147,10 @@ void test(
 
 int main(int argc, char *argv[])
 {
-	elem_t *A, *B, *C;
-	size_t n = 3000;
-	size_t nthreads = 0;
+	harness::benchmark bench("openmp", "matmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	elem_t *A, *B, *C;
+	size_t n = bench.arg(0, 3000);
 
 	A = new elem_t[n * n];
 	B = new elem_t[n * n];
@@ -164,28 +158,30 @@ int main(int argc, char *argv[])
 
 	fill(A, n);
 	fill(B, n);
-	zero(C, n);
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
 	omp_set_dynamic(0);
-	omp_set_num_threads(nthreads);
+	omp_set_num_threads(bench.nthreads());
+
+	bench.run([&](harness::benchmark &b) {
+		zero(C, n);
+
+		b.start_scheduler();
 
 #pragma omp parallel shared(A, B, C, n)
 #pragma omp single
-	test(A, B, C, n);
-
-	auto stop = system_clock::now();
+		{
+			b.start_compute();
+			test(A, B, C, n);
+			b.stop_compute();
+		}
+	});
 
-	cout << "Scheduler:  openmp\n";
-	cout << "Benchmark:  matmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check(A, B, C, n) << "\n";
+	bench.report(to_string(check(A, B, C, n)));
 
 	delete []C;
 	delete []B;
-	delete []A; 
+	delete []A;
 	return 0;
 }
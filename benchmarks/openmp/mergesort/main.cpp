@@ -1,12 +1,13 @@
 #include <iostream>
-#include <chrono>
+#include <vector>
 #include <thread>
 #include <cstring>
 
 #include <omp.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 typedef int elem_t;
 
@@ -53,9 +54,9 @@ void mergesort(size_t left, size_t right) {
 	size_t l = left;
 	size_t r = mid;
 
-#pragma omp task shared()
+#pragma omp task
 	mergesort(left, mid);
-#pragma omp task shared()
+#pragma omp task
 	mergesort(mid, right);
 
 #pragma omp taskwait
@@ -76,42 +77,40 @@ void mergesort(size_t left, size_t right) {
 }
 void test(size_t left, size_t right)
 {
-#pragma omp task shared()
+#pragma omp task
 	mergesort(left, right);
 #pragma omp taskwait
 }
 
 int main(int argc, char *argv[])
 {
-	size_t n = 8e7;
-	size_t nthreads = 0;
+	harness::benchmark bench("openmp", "mergesort", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t n = bench.arg(0, 8e7);
 
 	generate_data(n);
+	vector<elem_t> input(data, data + n);
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
 	omp_set_dynamic(0);
-	omp_set_num_threads(nthreads);
+	omp_set_num_threads(bench.nthreads());
 
-#pragma omp parallel shared(A, B, C, n)
-#pragma omp single
-	test(0, n);
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
+
+		b.start_scheduler();
 
-	auto stop = system_clock::now();
+#pragma omp parallel shared(n)
+#pragma omp single
+		{
+			b.start_compute();
+			test(0, n);
+			b.stop_compute();
+		}
+	});
 
-	cout << "Scheduler:  cilk\n";
-	cout << "Benchmark:  mergesort\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check() << "\n";
+	bench.report(to_string(check()));
 
 	return 0;
 }
@@ -2,34 +2,42 @@
 
 library('ggplot2')
 
+# CSV rows of run.sh, one per run
 read_input <- function (path) {
-    data.raw <- read.table(input, header=TRUE)
+    data.raw <- read.csv(path, header=TRUE)
 
-    sdev <- function (x) sqrt(var(x))
+    ci95 <- function (x) {
+        if (length(x) < 2)
+            return(0)
+        qt(0.975, df = length(x) - 1) * sd(x) / sqrt(length(x))
+    }
+    data.median <- aggregate(time ~ sched + name + threads, data.raw, median)
     data.mean <- aggregate(time ~ sched + name + threads, data.raw, mean)
-    data.sdev <- aggregate(time ~ sched + name + threads, data.raw, sdev)
-    data <- cbind(data.mean, sdev = data.sdev$time)
+    data.ci <- aggregate(time ~ sched + name + threads, data.raw, ci95)
+    data <- cbind(data.median,
+        low = data.mean$time - data.ci$time,
+        high = data.mean$time + data.ci$time)
     return(data)
 }
 
 my_plot <- function (data, name, title = 'atata') {
     d <- data[data$name==name,]
 
-    # t <- log(time)
-    p <- ggplot(d, aes(x = threads, y = log(time), group = sched, color = sched)) +
+    p <- ggplot(d, aes(x = threads, y = time, group = sched, color = sched)) +
         geom_line() +
         geom_point() +
-        # geom_errorbar(
-        #     aes(ymin = t - sdev, ymax = t + sdev),
-        #     width = .2,
-        #     position = position_dodge(0.05)
-        # ) +
+        geom_errorbar(
+            aes(ymin = pmax(low, 1), ymax = high),
+            width = .2,
+            position = position_dodge(0.05)
+        ) +
+        scale_y_log10() +
         labs(
             title = title,
             x = 'Number of threads',
             y = 'Execution time (us), log scale'
         ) +
-        scale_color_manual(values=c('#999999','#E69F00', '#4286f4'))
+        scale_color_manual(values=c('#999999','#E69F00', '#4286f4', '#d7191c', '#1a9641'))
 
     return(p)
 }
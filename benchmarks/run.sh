@@ -1,5 +1,6 @@
 #!/bin/bash
 
+warmups=1
 runs=6
 threads=({1..56})
 
@@ -8,7 +9,14 @@ args_dfs="9 9"
 args_mergesort="50000000"
 args_matmul="3000"
 args_blkmul="8"
-
+args_reduce="1000000000 0"
+args_scan="1000000000"
+args_sort="50000000"
+args_radixsort="100000000"
+args_histogram="1000000000 0"
+args_deque="0 100000000 64"
+
+warmups=1
 runs=2
 threads=(3 4)
 
@@ -17,6 +25,12 @@ args_dfs="9 9"
 args_mergesort="100000"
 args_matmul="800"
 args_blkmul="6"
+args_reduce="10000000 0"
+args_scan="10000000"
+args_sort="100000"
+args_radixsort="1000000"
+args_histogram="10000000 0"
+args_deque="0 1000000 64"
 
 benchmarks=(
 	"staccato fib _threads_ $args_fib"
@@ -24,44 +38,59 @@ benchmarks=(
 	# "staccato mergesort _threads_ $args_mergesort"
 	# "staccato matmul _threads_ $args_matmul"
 	# "staccato blkmul _threads_ $args_blkmul"
+	# "staccato reduce _threads_ $args_reduce"
+	# "staccato scan _threads_ $args_scan"
+	# "staccato sort _threads_ $args_sort"
+	# "staccato radixsort _threads_ $args_radixsort"
+	# "staccato histogram _threads_ $args_histogram"
+	# "staccato startup _threads_"
+	# "staccato deque _threads_ $args_deque"
 	# "cilk fib _threads_ $args_fib"
 	# "cilk dfs _threads_ $args_dfs"
 	# "cilk mergesort _threads_ $args_mergesort"
 	# "cilk matmul _threads_ $args_matmul"
 	# "cilk blkmul _threads_ $args_blkmul"
+	# "cilk radixsort _threads_ $args_radixsort"
+	# "openmp fib _threads_ $args_fib"
+	# "openmp dfs _threads_ $args_dfs"
+	# "openmp mergesort _threads_ $args_mergesort"
+	# "openmp matmul _threads_ $args_matmul"
+	# "openmp blkmul _threads_ $args_blkmul"
+	# "openmp radixsort _threads_ $args_radixsort"
 	# "tbb fib _threads_ $args_fib"
 	# "tbb dfs _threads_ $args_dfs"
 	# "tbb mergesort _threads_ $args_mergesort"
 	# "tbb matmul _threads_ $args_matmul"
 	# "tbb blkmul _threads_ $args_blkmul"
+	# "tbb reduce _threads_ $args_reduce"
+	# "tbb radixsort _threads_ $args_radixsort"
+	# "sequential fib _threads_ $args_fib"
+	# "sequential dfs _threads_ $args_dfs"
+	# "sequential mergesort _threads_ $args_mergesort"
+	# "sequential matmul _threads_ $args_matmul"
+	# "sequential blkmul _threads_ $args_blkmul"
+	# "sequential reduce _threads_ $args_reduce"
+	# "sequential scan _threads_ $args_scan"
+	# "sequential radixsort _threads_ $args_radixsort"
+	# "sequential histogram _threads_ $args_histogram"
 )
 
 # export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_DEBUG=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_ASYMMETRIC_FENCE=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_DEQUE=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_DEQUE=2
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_VICTIM=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_IDLE=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_IDLE=2
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_ALLOCATOR=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_TRACE=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_WORKSPAN=1
+# export CXXFLAGS=-I\ ~/.local/include/\ -DSTACCATO_PERF=1
 export CXXFLAGS=-I\ ~/.local/include/
 
-function get_integer() {
-	echo "$1" | grep "$2" | grep -o "[0-9].*"
-}
-
-function get_string() {
-	echo "$1" | grep "$2" | cut -f2 -d':'
-}
-
+# Header of the CSV rows printed by benchmarks/harness.hpp
 function print_header() {
-	echo sched name threads time input output
-}
-
-function show_results() {
-	output=$(cat /dev/stdin)
-
-	sched=$(get_string "$output" "Scheduler")
-	name=$(get_string "$output" "Benchmark")
-	threads=$(get_integer "$output" "Threads")
-	time=$(get_integer "$output" "Time(us)")
-	input=$(get_integer "$output" "Input")
-	output=$(get_integer "$output" "Output")
-
-	echo $sched $name $threads $time \"$input\" \"$output\"
+	echo sched,name,threads,input,output,run,startup,time,teardown
 }
 
 function clean() {
@@ -93,19 +122,16 @@ function build() {
 }
 
 function bench() {
-	runs=$1
-	dir=$2/$3/build/
-	bin=${3}-${2}
-	shift; shift; shift
+	dir=$1/$2/build/
+	bin=${2}-${1}
+	shift; shift
 	args=$@
 
 	pushd . >/dev/null
 
 	cd $dir
 
-	for (( i = 0; i < $runs; i++ )); do
-		./$bin $args | show_results
-	done
+	./$bin -f csv -w $warmups -r $runs $args | tail -n +2
 
 	popd >/dev/null
 }
@@ -129,7 +155,7 @@ function bench_all() {
 
 		for t in ${threads[@]} ; do
 			b=${benchmark/_threads_/$t}
-			bench $runs $b 
+			bench $b
 		done
 	done
 }
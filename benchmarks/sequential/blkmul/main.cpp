@@ -4,13 +4,13 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 #include <cstring>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 inline uint32_t xorshift_rand() {
 	static uint32_t x = 2463534242;
@@ -270,17 +270,16 @@ void seq_blkmul(Block *A, Block *B, Block *R, size_t n, bool do_mul) {
 
 int main(int argc, char *argv[])
 {
-	size_t log_n = 4;
+	harness::benchmark bench("sequential", "blkmul", argc, argv);
 
-	if (argc >= 3)
-		log_n = atoi(argv[2]);
+	size_t log_n = bench.arg(0, 4);
 
 	auto n = 1 << log_n;
 
-	cout << "Matrix dim: " << n * 16 << "\n";
+	cerr << "Matrix dim: " << n * 16 << "\n";
 	auto nblocks = n * n;
 
-	cout << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
+	cerr << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
 
 	auto A = new Block[nblocks];
 	auto B = new Block[nblocks];
@@ -289,22 +288,18 @@ int main(int argc, char *argv[])
 	fill(A, nblocks);
 	fill(B, nblocks);
 
-	auto start = system_clock::now();
-
-	seq_blkmul(A, B, R, nblocks);
+	bench.input(to_string(log_n));
 
-	auto stop = system_clock::now();
+	bench.run([&](harness::benchmark &b) {
+		b.start_compute();
+		seq_blkmul(A, B, R, nblocks);
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  sequential\n";
-	cout << "Benchmark:  blkmul\n";
-	cout << "Threads:    " << 0 << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << log_n << "\n";
-	cout << "Output:     " << check(A, B, R, nblocks) << "\n";
+	bench.report(to_string(check(A, B, R, nblocks)));
 
 	delete []A;
 	delete []B;
 	delete []R;
 	return 0;
 }
-
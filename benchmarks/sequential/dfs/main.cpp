@@ -1,10 +1,10 @@
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <thread>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 void seq_dfs(size_t depth, size_t breadth, unsigned long *sum)
 {
@@ -25,27 +25,21 @@ void seq_dfs(size_t depth, size_t breadth, unsigned long *sum)
 
 int main(int argc, char *argv[])
 {
-	size_t depth = 8;
-	size_t breadth = 8;
-	unsigned long answer;
+	harness::benchmark bench("sequential", "dfs", argc, argv);
 
-	if (argc >= 3)
-		depth = atoi(argv[2]);
-	if (argc >= 4)
-		breadth = atoi(argv[3]);
-
-	auto start = system_clock::now();
+	size_t depth = bench.arg(0, 8);
+	size_t breadth = bench.arg(1, 8);
+	unsigned long answer;
 
-	seq_dfs(depth, breadth, &answer);
+	bench.input(to_string(depth) + " " + to_string(breadth));
 
-	auto stop = system_clock::now();
+	bench.run([&](harness::benchmark &b) {
+		b.start_compute();
+		seq_dfs(depth, breadth, &answer);
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  sequential\n";
-	cout << "Benchmark:  dfs\n";
-	cout << "Threads:    " << 0 << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << depth << " " << breadth << "\n";
-	cout << "Output:     " << answer << "\n";
+	bench.report(to_string(answer));
 
 	return 0;
 }
@@ -1,9 +1,9 @@
 #include <iostream>
-#include <chrono>
 #include <thread>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 void fib_seq(size_t n, unsigned long *sum)
 {
@@ -25,24 +25,20 @@ void fib_seq(size_t n, unsigned long *sum)
 
 int main(int argc, char *argv[])
 {
-	size_t n = 40;
-	unsigned long answer;
+	harness::benchmark bench("sequential", "fib", argc, argv);
 
-	if (argc >= 3)
-		n = atoi(argv[2]);
-
-	auto start = system_clock::now();
+	int n = bench.arg(0, 40);
+	unsigned long answer;
 
-	fib_seq(n, &answer);
+	bench.input(to_string(n));
 
-	auto stop = system_clock::now();
+	bench.run([&](harness::benchmark &b) {
+		b.start_compute();
+		fib_seq(n, &answer);
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  sequential\n";
-	cout << "Benchmark:  fib\n";
-	cout << "Threads:    " << 0 << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << answer << "\n";
+	bench.report(to_string(answer));
 
 	return 0;
 }
@@ -0,0 +1,46 @@
+#include <iostream>
+#include <thread>
+
+#include "../../harness.hpp"
+
+using namespace std;
+
+static const size_t nbins = 256;
+
+inline size_t bin(uint64_t i) {
+	i ^= i >> 33;
+	i *= 0xff51afd7ed558ccdull;
+	i ^= i >> 33;
+	return i % nbins;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("sequential", "histogram", argc, argv);
+
+	size_t n = bench.arg(0, 1e9);
+
+	uint64_t bins[nbins];
+
+	bench.input(to_string(n));
+
+	bench.run([&](harness::benchmark &b) {
+		for (size_t i = 0; i < nbins; ++i)
+			bins[i] = 0;
+
+		b.start_compute();
+
+		for (uint64_t i = 0; i < n; ++i)
+			bins[bin(i)]++;
+
+		b.stop_compute();
+	});
+
+	uint64_t checksum = 0;
+	for (size_t i = 0; i < nbins; ++i)
+		checksum += bins[i] * i;
+
+	bench.report(to_string(checksum));
+
+	return 0;
+}
@@ -12,12 +12,12 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 
 typedef float elem_t;
 
@@ -122,12 +122,12 @@ void seq_matmul(
 	}
 }
 
-int main(int argc, char *argv[]) {
-	elem_t *A, *B, *C;
-	size_t n = 3000;
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("sequential", "matmul", argc, argv);
 
-	if (argc >= 3)
-		n = atoi(argv[2]);
+	elem_t *A, *B, *C;
+	size_t n = bench.arg(0, 3000);
 
 	A = new elem_t[n * n];
 	B = new elem_t[n * n];
@@ -135,23 +135,21 @@ int main(int argc, char *argv[]) {
 
 	fill(A, n);
 	fill(B, n);
-	zero(C, n);
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
-	seq_matmul(A, B, C, n, n, n, n, 0);
+	bench.run([&](harness::benchmark &b) {
+		zero(C, n);
 
-	auto stop = system_clock::now();
+		b.start_compute();
+		seq_matmul(A, B, C, n, n, n, n, 0);
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  sequential\n";
-	cout << "Benchmark:  matmul\n";
-	cout << "Threads:    " << 0 << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check(A, B, C, n) << "\n";
+	bench.report(to_string(check(A, B, C, n)));
 
 	delete []C;
 	delete []B;
-	delete []A; 
+	delete []A;
 	return 0;
 }
@@ -1,12 +1,13 @@
 #include <iostream>
-#include <chrono>
+#include <vector>
 #include <thread>
 
 #include <staccato/task.hpp>
 #include <staccato/scheduler.hpp>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace staccato;
 
 typedef int elem_t;
@@ -73,25 +74,24 @@ void seq_matmul(size_t left, size_t right)
 
 int main(int argc, char *argv[])
 {
-	size_t n = 8e7;
+	harness::benchmark bench("sequential", "mergesort", argc, argv);
 
-	if (argc >= 3)
-		n = atoi(argv[2]);
+	size_t n = bench.arg(0, 8e7);
 
 	generate_data(n);
+	vector<elem_t> input(data, data + n);
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
-	seq_matmul(0, n);
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
 
-	auto stop = system_clock::now();
+		b.start_compute();
+		seq_matmul(0, n);
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  sequential\n";
-	cout << "Benchmark:  mergesort\n";
-	cout << "Threads:    " << 0 << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check() << "\n";
+	bench.report(to_string(check()));
 
 	return 0;
 }
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cstring>
+
+#include "../../harness.hpp"
+
+using namespace std;
+
+typedef uint64_t elem_t;
+
+size_t lenght = 0;
+elem_t *data = nullptr;
+elem_t sum_before = 0;
+
+inline uint64_t xorshift_rand() {
+	static uint64_t x = 88172645463325252ull;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	return x * 2685821657736338717ull;
+}
+
+void generate_data(size_t n) {
+	lenght = n;
+	data = new elem_t[n];
+	sum_before = 0;
+	for (size_t i = 0; i < n; ++i) {
+		data[i] = xorshift_rand();
+		sum_before += data[i];
+	}
+}
+
+bool check() {
+	elem_t s = data[0];
+	for (size_t i = 1; i < lenght; ++i) {
+		s += data[i];
+		if (data[i - 1] > data[i])
+			return false;
+	}
+
+	return sum_before == s;
+}
+
+static const unsigned radix_bits = 8;
+static const size_t radix_buckets = 1 << radix_bits;
+static const unsigned npasses = sizeof(elem_t) * 8 / radix_bits;
+
+inline size_t digit(elem_t x, unsigned pass) {
+	return (x >> (pass * radix_bits)) & (radix_buckets - 1);
+}
+
+void radixsort(elem_t *a, size_t n) {
+	size_t counts[npasses][radix_buckets];
+	memset(counts, 0, sizeof(counts));
+
+	for (size_t i = 0; i < n; ++i)
+		for (unsigned p = 0; p < npasses; ++p)
+			counts[p][digit(a[i], p)]++;
+
+	elem_t *tmp = new elem_t[n];
+	elem_t *src = a;
+	elem_t *dst = tmp;
+
+	for (unsigned p = 0; p < npasses; ++p) {
+		if (counts[p][digit(a[0], p)] == n)
+			continue;
+
+		size_t offsets[radix_buckets];
+		size_t s = 0;
+		for (size_t b = 0; b < radix_buckets; ++b) {
+			offsets[b] = s;
+			s += counts[p][b];
+		}
+
+		for (size_t i = 0; i < n; ++i)
+			dst[offsets[digit(src[i], p)]++] = src[i];
+
+		swap(src, dst);
+	}
+
+	if (src != a)
+		memcpy(a, src, n * sizeof(elem_t));
+
+	delete []tmp;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("sequential", "radixsort", argc, argv);
+
+	size_t n = bench.arg(0, 1e8);
+
+	generate_data(n);
+	vector<elem_t> input(data, data + n);
+
+	bench.input(to_string(n));
+
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
+
+		b.start_compute();
+		radixsort(data, n);
+		b.stop_compute();
+	});
+
+	bench.report(to_string(check()));
+
+	delete []data;
+	return 0;
+}
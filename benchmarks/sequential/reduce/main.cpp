@@ -0,0 +1,56 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "../../harness.hpp"
+
+using namespace std;
+
+typedef double elem_t;
+
+inline uint32_t xorshift_rand() {
+	static uint32_t x = 2463534242;
+	x ^= x >> 13;
+	x ^= x << 17;
+	x ^= x >> 5;
+	return x;
+}
+
+elem_t *generate_data(size_t n)
+{
+	auto data = new elem_t[n];
+	for (size_t i = 0; i < n; ++i)
+		data[i] = 1.0 / (1 + xorshift_rand() % 1000);
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("sequential", "reduce", argc, argv);
+
+	size_t n = bench.arg(0, 1e8);
+
+	auto data = generate_data(n);
+
+	elem_t answer;
+
+	bench.input(to_string(n));
+
+	bench.run([&](harness::benchmark &b) {
+		b.start_compute();
+
+		answer = 0.0;
+		for (size_t i = 0; i < n; ++i)
+			answer += data[i];
+
+		b.stop_compute();
+	});
+
+	ostringstream output;
+	output << setprecision(17) << answer;
+	bench.report(output.str());
+
+	delete []data;
+	return 0;
+}
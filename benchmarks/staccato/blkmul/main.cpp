@@ -4,7 +4,6 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 #include <cstring>
@@ -12,8 +11,9 @@
 #include <staccato/task.hpp>
 #include <staccato/scheduler.hpp>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace staccato;
 
 inline uint32_t xorshift_rand() {
@@ -230,10 +230,12 @@ void OperationTask::add()
 
 	auto q = n / 4;
 
-	spawn(new(child()) OperationTask(A+0*q, B+0*q, R+0*q, q, false));
-	spawn(new(child()) OperationTask(A+1*q, B+1*q, R+1*q, q, false));
-	spawn(new(child()) OperationTask(A+2*q, B+2*q, R+2*q, q, false));
-	spawn(new(child()) OperationTask(A+3*q, B+3*q, R+3*q, q, false));
+	new(child(0)) OperationTask(A+0*q, B+0*q, R+0*q, q, false);
+	new(child(1)) OperationTask(A+1*q, B+1*q, R+1*q, q, false);
+	new(child(2)) OperationTask(A+2*q, B+2*q, R+2*q, q, false);
+	new(child(3)) OperationTask(A+3*q, B+3*q, R+3*q, q, false);
+
+	spawn_n(4);
 
 	wait();
 }
@@ -251,28 +253,25 @@ void OperationTask::mul() {
 
 	auto q = n / 4;
 
-	auto l = new Block[n];
+	auto l = scratch<Block>(n);
+	auto r = scratch<Block>(n);
 
-	spawn(new(child()) OperationTask(A+0*q, B+0*q, l+0*q, q));
-	spawn(new(child()) OperationTask(A+0*q, B+1*q, l+1*q, q));
-	spawn(new(child()) OperationTask(A+2*q, B+0*q, l+2*q, q));
-	spawn(new(child()) OperationTask(A+2*q, B+1*q, l+3*q, q));
+	new(child(0)) OperationTask(A+0*q, B+0*q, l+0*q, q);
+	new(child(1)) OperationTask(A+0*q, B+1*q, l+1*q, q);
+	new(child(2)) OperationTask(A+2*q, B+0*q, l+2*q, q);
+	new(child(3)) OperationTask(A+2*q, B+1*q, l+3*q, q);
+	new(child(4)) OperationTask(A+1*q, B+2*q, r+0*q, q);
+	new(child(5)) OperationTask(A+1*q, B+3*q, r+1*q, q);
+	new(child(6)) OperationTask(A+3*q, B+2*q, r+2*q, q);
+	new(child(7)) OperationTask(A+3*q, B+3*q, r+3*q, q);
 
-	auto r = new Block[n];
-
-	spawn(new(child()) OperationTask(A+1*q, B+2*q, r+0*q, q));
-	spawn(new(child()) OperationTask(A+1*q, B+3*q, r+1*q, q));
-	spawn(new(child()) OperationTask(A+3*q, B+2*q, r+2*q, q));
-	spawn(new(child()) OperationTask(A+3*q, B+3*q, r+3*q, q));
+	spawn_n(8);
 
 	wait();
 
 	A = l;
 	B = r;
 	add();
-
-	delete []r;
-	delete []l;
 }
 
 void OperationTask::execute()
@@ -320,22 +319,16 @@ bool check(Block *A, Block *B, Block *C, size_t n)
 
 int main(int argc, char *argv[])
 {
-	size_t log_n = 4;
-	size_t nthreads = 0;
+	harness::benchmark bench("staccato", "blkmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		log_n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t log_n = bench.arg(0, 4);
 
 	auto n = 1 << log_n;
 
-	cout << "Matrix dim: " << n * 16 << "\n";
+	cerr << "Matrix dim: " << n * 16 << "\n";
 	auto nblocks = n * n;
 
-	cout << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
+	cerr << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
 
 	auto A = new Block[nblocks];
 	auto B = new Block[nblocks];
@@ -344,26 +337,21 @@ int main(int argc, char *argv[])
 	fill(A, nblocks);
 	fill(B, nblocks);
 
-	auto start = system_clock::now();
+	bench.input(to_string(log_n));
 
-	{
-		scheduler<OperationTask> sh(8, nthreads);
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
+		scheduler<OperationTask> sh(8, b.nthreads());
+		b.start_compute();
 		sh.spawn(new(sh.root()) OperationTask(A, B, R, nblocks));
 		sh.wait();
-	}
-
-	auto stop = system_clock::now();
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  staccato\n";
-	cout << "Benchmark:  blkmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << log_n << "\n";
-	cout << "Output:     " << check(A, B, R, nblocks) << "\n";
+	bench.report(to_string(check(A, B, R, nblocks)));
 
 	delete []A;
 	delete []B;
 	delete []R;
 	return 0;
 }
-
@@ -0,0 +1,307 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <staccato/task_deque.hpp>
+#include <staccato/lifo_allocator.hpp>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace staccato;
+using namespace staccato::internal;
+
+// Microbenchmark of task_deque alone, without the scheduler. The main
+// thread owns the deque, the other threads are thieves. Modes:
+//   0 (owner): the owner fills the deque and takes it back while thieves
+//              steal, i.e. put/take throughput under contention
+//   1 (steal): the owner only puts, steal throughput of the thieves
+//   2 (race):  the owner puts a single task and takes it while thieves
+//              try to steal it, latency distribution of take()
+// The deque variant is chosen by STACCATO_DEQUE as for the scheduler.
+// Private deques can't be stolen from, so they only run without thieves.
+
+struct item
+{
+	size_t value;
+};
+
+typedef task_deque<item> deque_t;
+
+enum mode_e {
+	mode_owner = 0,
+	mode_steal = 1,
+	mode_race  = 2
+};
+
+static const char *mode_names[] = {"owner", "steal", "race"};
+
+struct thief_stats
+{
+	size_t stolen;
+	size_t empty;
+	size_t races;
+	size_t sum;
+};
+
+struct shared_state
+{
+	deque_t *deque;
+	mode_e mode;
+
+	// Waiting threads spin only if each has a core, otherwise the one
+	// they wait for could be descheduled for a whole time slice
+	bool spin;
+
+	STACCATO_ALIGN atomic_bool stop;
+	STACCATO_ALIGN atomic_size_t nready;
+
+	// Tasks stolen and returned by the thieves
+	STACCATO_ALIGN atomic_size_t nstolen;
+
+	// Race mode: the round thieves may try once, and the number of tries
+	STACCATO_ALIGN atomic_size_t round;
+	STACCATO_ALIGN atomic_size_t ntries;
+};
+
+void thief(shared_state *s, thief_stats *st)
+{
+	*st = thief_stats();
+	size_t seen = 0;
+
+	s->nready++;
+
+	while (!load_relaxed(s->stop)) {
+		if (s->mode == mode_race) {
+			auto r = load_acquire(s->round);
+			if (r == seen) {
+				if (!s->spin)
+					this_thread::yield();
+				continue;
+			}
+			seen = r;
+		}
+
+		bool was_empty = false;
+		auto t = s->deque->steal(&was_empty);
+
+		if (t) {
+			st->sum += t->value;
+			st->stolen++;
+			s->deque->return_stolen();
+			s->nstolen.fetch_add(1, memory_order_release);
+		} else if (was_empty) {
+			// As workers with the default yield_idle policy do
+			st->empty++;
+			this_thread::yield();
+		} else {
+			st->races++;
+		}
+
+		if (s->mode == mode_race)
+			s->ntries.fetch_add(1, memory_order_release);
+	}
+}
+
+// Puts n tasks in rounds of a full deque. Slots are reused only after
+// every task of the round is taken or stolen and returned.
+size_t put_take(shared_state *s, size_t n, size_t size, size_t *sum)
+{
+	auto d = s->deque;
+	size_t ntaken = 0;
+
+	for (size_t v = 0; v < n;) {
+		for (size_t i = 0; i < size; ++i, ++v) {
+			new(d->put_allocate()) item({v});
+			d->put_commit();
+		}
+
+		if (s->mode == mode_owner) {
+			size_t nstolen;
+			while (auto t = d->take(&nstolen)) {
+				*sum += t->value;
+				ntaken++;
+			}
+		}
+
+		while (ntaken + load_acquire(s->nstolen) < v) {
+			// The owner of a split deque shares its tasks only in put and
+			// take, so the newest one is taken and put back
+			if (deque_t::variant() == STACCATO_DEQUE_SPLIT) {
+				size_t nstolen;
+				if (auto t = d->take(&nstolen)) {
+					new(d->put_allocate()) item(*t);
+					d->put_commit();
+				}
+			}
+
+			if (!s->spin)
+				this_thread::yield();
+		}
+	}
+
+	return ntaken;
+}
+
+// Take latencies in TSC cycles, one per round
+size_t race(shared_state *s, size_t n, size_t nthieves, size_t *sum,
+		vector<uint64_t> *latencies)
+{
+	auto d = s->deque;
+	size_t ntaken = 0;
+
+	for (size_t v = 0; v < n; ++v) {
+		new(d->put_allocate()) item({v});
+		d->put_commit();
+
+		store_release(s->round, v + 1);
+
+		size_t nstolen;
+		auto t0 = read_tsc();
+		auto t = d->take(&nstolen);
+		auto t1 = read_tsc();
+
+		latencies->push_back(t1 - t0);
+
+		if (t) {
+			*sum += t->value;
+			ntaken++;
+		}
+
+		while (load_acquire(s->ntries) < (v + 1) * nthieves)
+			if (!s->spin)
+				this_thread::yield();
+	}
+
+	return ntaken;
+}
+
+uint64_t percentile(const vector<uint64_t> &sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+	return sorted[size_t(p * (sorted.size() - 1))];
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "deque", argc, argv);
+
+	auto mode = static_cast<mode_e>(bench.arg(0, mode_owner));
+	size_t n = bench.arg(1, mode == mode_race ? 1e6 : 1e7);
+	size_t size = bench.arg(2, 64);
+	size_t nthieves = bench.nthreads() - 1;
+
+	if (mode > mode_race || !is_pow2(size)) {
+		cerr << "Usage: " << argv[0] << " [options] [threads [mode(0..2) [n [size(pow2)]]]]\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (mode != mode_owner && nthieves == 0) {
+		cerr << "Mode " << mode_names[mode] << " needs at least one thief\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (deque_t::variant() == STACCATO_DEQUE_PRIVATE && nthieves > 0) {
+		cerr << "Private deques can't be stolen from\n";
+		exit(EXIT_FAILURE);
+	}
+
+	// Whole rounds of a full deque
+	if (mode != mode_race)
+		n = (n + size - 1) / size * size;
+
+	lifo_allocator alloc(deque_t::footprint(size) + STACCATO_CACHE_SIZE);
+
+	size_t ntaken = 0;
+	size_t sum = 0;
+	vector<thief_stats> stats(nthieves);
+	vector<uint64_t> latencies;
+	double seconds = 0;
+
+	bench.input(string(mode_names[mode]) + " " + to_string(n) + " " + to_string(size));
+
+	bench.run([&](harness::benchmark &b) {
+		auto d = alloc.alloc_extended<deque_t>(deque_t::footprint(size));
+		new(d) deque_t(size);
+
+		shared_state s;
+		s.deque = d;
+		s.mode = mode;
+		s.spin = b.nthreads() <= thread::hardware_concurrency();
+		s.stop = false;
+		s.nready = 0;
+		s.nstolen = 0;
+		s.round = 0;
+		s.ntries = 0;
+
+		vector<thread> thieves;
+		for (size_t i = 0; i < nthieves; ++i)
+			thieves.emplace_back(thief, &s, &stats[i]);
+
+		while (s.nready < nthieves)
+			this_thread::yield();
+
+		sum = 0;
+		latencies.clear();
+		latencies.reserve(mode == mode_race ? n : 0);
+
+		b.start_compute();
+		auto start = steady_clock::now();
+
+		if (mode == mode_race)
+			ntaken = race(&s, n, nthieves, &sum, &latencies);
+		else
+			ntaken = put_take(&s, n, size, &sum);
+
+		seconds = duration<double>(steady_clock::now() - start).count();
+		b.stop_compute();
+
+		s.stop = true;
+		for (auto &t : thieves)
+			t.join();
+
+		d->~deque_t();
+	});
+
+	thief_stats total = thief_stats();
+	for (auto &st : stats) {
+		total.stolen += st.stolen;
+		total.empty += st.empty;
+		total.races += st.races;
+		total.sum += st.sum;
+	}
+
+	auto attempts = total.stolen + total.empty + total.races;
+	auto rate = [](size_t x, size_t of) { return of ? 100.0 * x / of : 0.0; };
+
+	ostringstream output;
+	output << fixed << setprecision(1);
+
+	if (mode == mode_race) {
+		sort(latencies.begin(), latencies.end());
+		output << "take p50 " << percentile(latencies, 0.5)
+			<< " p90 " << percentile(latencies, 0.9)
+			<< " p99 " << percentile(latencies, 0.99)
+			<< " max " << percentile(latencies, 1.0) << " cycles"
+			<< ", owner won " << rate(ntaken, n) << "%";
+	} else {
+		output << (mode == mode_owner ? "put+take " : "steal ")
+			<< (mode == mode_owner ? 2 * n : n) / seconds / 1e6 << " Mops/s"
+			<< ", stolen " << total.stolen;
+	}
+
+	output << ", steal success " << rate(total.stolen, attempts) << "%"
+		<< ", races " << rate(total.races, attempts) << "%"
+		<< ", check " << (sum + total.sum == n * (n - 1) / 2 && ntaken + total.stolen == n);
+
+	bench.report(output.str());
+
+	return 0;
+}
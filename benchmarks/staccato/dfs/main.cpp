@@ -1,13 +1,12 @@
 #include <iostream>
-#include <vector>
-#include <chrono>
 #include <thread>
 
 #include <staccato/task.hpp>
 #include <staccato/scheduler.hpp>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace staccato;
 
 class DFSTask: public task<DFSTask>
@@ -25,10 +24,14 @@ public:
 			return;
 		}
 
-		vector<unsigned long> sums(breadth);
+		auto sums = scratch<unsigned long>(breadth);
 
-		for (size_t i = 0; i < breadth; ++i)
-			spawn(new(child()) DFSTask(depth - 1, breadth, &sums[i]));
+		for (size_t i = 0; i < breadth - 1; ++i)
+			new(child(i)) DFSTask(depth - 1, breadth, sums + i);
+
+		spawn_n(breadth - 1);
+
+		call(new(child()) DFSTask(depth - 1, breadth, sums + breadth - 1));
 
 		wait();
 
@@ -47,36 +50,24 @@ private:
 
 int main(int argc, char *argv[])
 {
-	size_t depth = 8;
-	size_t breadth = 8;
-	unsigned long answer;
-	size_t nthreads = 0;
+	harness::benchmark bench("staccato", "dfs", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		depth = atoi(argv[2]);
-	if (argc >= 4)
-		breadth = atoi(argv[3]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t depth = bench.arg(0, 8);
+	size_t breadth = bench.arg(1, 8);
+	unsigned long answer;
 
-	auto start = system_clock::now();
+	bench.input(to_string(depth) + " " + to_string(breadth));
 
-	{
-		scheduler<DFSTask> sh(breadth, nthreads);
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
+		scheduler<DFSTask> sh(breadth, b.nthreads());
+		b.start_compute();
 		sh.spawn(new(sh.root()) DFSTask(depth, breadth, &answer));
 		sh.wait();
-	}
-
-	auto stop = system_clock::now();
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  staccato\n";
-	cout << "Benchmark:  dfs\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << depth << " " << breadth << "\n";
-	cout << "Output:     " << answer << "\n";
+	bench.report(to_string(answer));
 
 	return 0;
 }
@@ -1,17 +1,19 @@
 #include <iostream>
-#include <chrono>
 #include <thread>
 
 #include <staccato/task.hpp>
 #include <staccato/scheduler.hpp>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace staccato;
 
 class FibTask: public task<FibTask>
 {
 public:
+	static constexpr size_t taskgraph_degree = 2;
+
 	FibTask (int n_, unsigned long *sum_): n(n_), sum(sum_)
 	{ }
 
@@ -25,7 +27,7 @@ public:
 		spawn(new(child()) FibTask(n - 1, &x));
 
 		unsigned long y;
-		spawn(new(child()) FibTask(n - 2, &y));
+		call(new(child()) FibTask(n - 2, &y));
 
 		wait();
 
@@ -41,33 +43,23 @@ private:
 
 int main(int argc, char *argv[])
 {
-	size_t n = 40;
-	unsigned long answer;
-	size_t nthreads = 0;
+	harness::benchmark bench("staccato", "fib", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	int n = bench.arg(0, 40);
+	unsigned long answer;
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
-	{
-		scheduler<FibTask> sh(2, nthreads);
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
+		scheduler<FibTask> sh(b.nthreads());
+		b.start_compute();
 		sh.spawn(new(sh.root()) FibTask(n, &answer));
 		sh.wait();
-	}
-
-	auto stop = system_clock::now();
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  staccato\n";
-	cout << "Benchmark:  fib\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << answer << "\n";
+	bench.report(to_string(answer));
 
 	return 0;
 }
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+#include <staccato/task.hpp>
+#include <staccato/scheduler.hpp>
+#include <staccato/reducer.hpp>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace staccato;
+
+static const size_t nbins = 256;
+static const size_t grain = 1 << 16;
+
+// Elements are not stored: the bin of element i is a hash of i
+inline size_t bin(uint64_t i) {
+	i ^= i >> 33;
+	i *= 0xff51afd7ed558ccdull;
+	i ^= i >> 33;
+	return i % nbins;
+}
+
+struct histogram
+{
+	histogram() : bins() { }
+
+	histogram operator+(const histogram &h) const {
+		histogram r;
+		for (size_t i = 0; i < nbins; ++i)
+			r.bins[i] = bins[i] + h.bins[i];
+		return r;
+	}
+
+	uint64_t bins[nbins];
+};
+
+reducer<histogram> *bins_reducer;
+atomic<uint64_t> bins_atomic[nbins];
+
+class HistTask: public task<HistTask>
+{
+public:
+	HistTask (uint64_t first, uint64_t last, bool use_atomics)
+	: first(first)
+	, last(last)
+	, use_atomics(use_atomics)
+	{ }
+
+	void execute() {
+		if (last - first <= grain) {
+			if (use_atomics) {
+				for (auto i = first; i < last; ++i)
+					bins_atomic[bin(i)].fetch_add(1, memory_order_relaxed);
+			} else {
+				auto &h = bins_reducer->view();
+				for (auto i = first; i < last; ++i)
+					h.bins[bin(i)]++;
+			}
+			return;
+		}
+
+		auto mid = first + (last - first) / 2;
+
+		spawn(new(child()) HistTask(first, mid, use_atomics));
+		spawn(new(child()) HistTask(mid, last, use_atomics));
+
+		wait();
+	}
+
+private:
+	uint64_t first;
+	uint64_t last;
+	bool use_atomics;
+};
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "histogram", argc, argv);
+
+	size_t n = bench.arg(0, 1e9);
+	bool use_atomics = bench.arg(1, 0);
+
+	size_t height = 1;
+	while ((n >> height) > grain)
+		height++;
+
+	histogram answer;
+
+	bench.input(to_string(n) + " " + to_string(use_atomics));
+
+	bench.run([&](harness::benchmark &b) {
+		for (size_t i = 0; i < nbins; ++i)
+			bins_atomic[i] = 0;
+
+		b.start_scheduler();
+
+		scheduler<HistTask> sh(2, b.nthreads(), height + 1);
+		reducer<histogram> r(sh);
+		bins_reducer = &r;
+
+		b.start_compute();
+
+		sh.spawn(new(sh.root()) HistTask(0, n, use_atomics));
+		sh.wait();
+
+		if (use_atomics) {
+			for (size_t i = 0; i < nbins; ++i)
+				answer.bins[i] = bins_atomic[i].load();
+		} else {
+			answer = r.get();
+		}
+
+		b.stop_compute();
+	});
+
+	uint64_t checksum = 0;
+	for (size_t i = 0; i < nbins; ++i)
+		checksum += answer.bins[i] * i;
+
+	bench.report(to_string(checksum));
+
+	return 0;
+}
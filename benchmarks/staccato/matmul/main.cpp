@@ -12,15 +12,15 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 
 #include <staccato/task.hpp>
 #include <staccato/scheduler.hpp>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace staccato;
 
 typedef float elem_t;
@@ -159,17 +159,12 @@ private:
 	bool add;
 };
 
-int main(int argc, char *argv[]) {
-	elem_t *A, *B, *C;
-	size_t n = 3000;
-	size_t nthreads = 0;
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "matmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	elem_t *A, *B, *C;
+	size_t n = bench.arg(0, 3000);
 
 	A = new elem_t[n * n];
 	B = new elem_t[n * n];
@@ -177,27 +172,24 @@ int main(int argc, char *argv[]) {
 
 	fill(A, n);
 	fill(B, n);
-	zero(C, n);
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
-	{
-		scheduler<MultTask> sh(2, nthreads);
+	bench.run([&](harness::benchmark &b) {
+		zero(C, n);
+
+		b.start_scheduler();
+		scheduler<MultTask> sh(2, b.nthreads());
+		b.start_compute();
 		sh.spawn(new(sh.root()) MultTask(A, B, C, n, n, n, n, 0));
 		sh.wait();
-	}
-
-	auto stop = system_clock::now();
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  staccato\n";
-	cout << "Benchmark:  matmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check(A, B, C, n) << "\n";
+	bench.report(to_string(check(A, B, C, n)));
 
 	delete []C;
 	delete []B;
-	delete []A; 
+	delete []A;
 	return 0;
 }
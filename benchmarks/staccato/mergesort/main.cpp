@@ -1,12 +1,13 @@
 #include <iostream>
-#include <chrono>
+#include <vector>
 #include <thread>
 
 #include <staccato/task.hpp>
 #include <staccato/scheduler.hpp>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace staccato;
 
 typedef int elem_t;
@@ -101,34 +102,27 @@ private:
 
 int main(int argc, char *argv[])
 {
-	size_t n = 8e7;
-	size_t nthreads = 0;
+	harness::benchmark bench("staccato", "mergesort", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t n = bench.arg(0, 8e7);
 
 	generate_data(n);
+	vector<elem_t> input(data, data + n);
 
-	auto start = system_clock::now();
+	bench.input(to_string(n));
 
-	{
-		scheduler<SortTask> sh(2, nthreads);
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
+
+		b.start_scheduler();
+		scheduler<SortTask> sh(2, b.nthreads());
+		b.start_compute();
 		sh.spawn(new(sh.root()) SortTask(0, n));
 		sh.wait();
-	}
-
-	auto stop = system_clock::now();
+		b.stop_compute();
+	});
 
-	cout << "Scheduler:  staccato\n";
-	cout << "Benchmark:  mergesort\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check() << "\n";
+	bench.report(to_string(check()));
 
 	return 0;
 }
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+
+#include <staccato/parallel_radix_sort.hpp>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace staccato;
+
+typedef uint64_t elem_t;
+
+size_t lenght = 0;
+elem_t *data = nullptr;
+elem_t sum_before = 0;
+
+inline uint64_t xorshift_rand() {
+	static uint64_t x = 88172645463325252ull;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	return x * 2685821657736338717ull;
+}
+
+void generate_data(size_t n) {
+	lenght = n;
+	data = new elem_t[n];
+	sum_before = 0;
+	for (size_t i = 0; i < n; ++i) {
+		data[i] = xorshift_rand();
+		sum_before += data[i];
+	}
+}
+
+bool check() {
+	elem_t s = data[0];
+	for (size_t i = 1; i < lenght; ++i) {
+		s += data[i];
+		if (data[i - 1] > data[i])
+			return false;
+	}
+
+	return sum_before == s;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "radixsort", argc, argv);
+
+	size_t n = bench.arg(0, 1e8);
+
+	generate_data(n);
+	vector<elem_t> input(data, data + n);
+
+	bench.input(to_string(n));
+
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
+
+		b.start_compute();
+		parallel_radix_sort(data, n, b.nthreads());
+		b.stop_compute();
+	});
+
+	bench.report(to_string(check()));
+
+	delete []data;
+	return 0;
+}
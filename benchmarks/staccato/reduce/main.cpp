@@ -0,0 +1,68 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include <staccato/parallel_reduce.hpp>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace staccato;
+
+typedef double elem_t;
+
+static const size_t grain = 4096;
+
+inline uint32_t xorshift_rand() {
+	static uint32_t x = 2463534242;
+	x ^= x >> 13;
+	x ^= x << 17;
+	x ^= x >> 5;
+	return x;
+}
+
+elem_t *generate_data(size_t n)
+{
+	auto data = new elem_t[n];
+	for (size_t i = 0; i < n; ++i)
+		data[i] = 1.0 / (1 + xorshift_rand() % 1000);
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "reduce", argc, argv);
+
+	size_t n = bench.arg(0, 1e8);
+	bool deterministic = bench.arg(1, 0);
+
+	auto data = generate_data(n);
+
+	auto map = [=](size_t i) { return data[i]; };
+	auto combine = [](elem_t a, elem_t b) { return a + b; };
+
+	elem_t answer;
+
+	bench.input(to_string(n) + " " + to_string(deterministic));
+
+	bench.run([&](harness::benchmark &b) {
+		b.start_compute();
+
+		if (deterministic)
+			answer = deterministic_parallel_reduce(
+				range(0, n, grain), 0.0, map, combine, b.nthreads());
+		else
+			answer = parallel_reduce(
+				range(0, n, grain), 0.0, map, combine, b.nthreads());
+
+		b.stop_compute();
+	});
+
+	ostringstream output;
+	output << setprecision(17) << answer;
+	bench.report(output.str());
+
+	delete []data;
+	return 0;
+}
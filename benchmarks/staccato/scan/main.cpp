@@ -0,0 +1,73 @@
+#include <iostream>
+#include <thread>
+#include <functional>
+
+#include <staccato/parallel_scan.hpp>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace staccato;
+
+typedef int64_t elem_t;
+
+class xorshift
+{
+public:
+	uint32_t operator()() {
+		x ^= x >> 13;
+		x ^= x << 17;
+		x ^= x >> 5;
+		return x;
+	}
+
+private:
+	uint32_t x = 2463534242;
+};
+
+elem_t *generate_data(size_t n)
+{
+	xorshift rand;
+	auto data = new elem_t[n];
+	for (size_t i = 0; i < n; ++i)
+		data[i] = rand() % 1000;
+	return data;
+}
+
+bool check(elem_t *data, size_t n)
+{
+	xorshift rand;
+	elem_t s = 0;
+	for (size_t i = 0; i < n; ++i) {
+		s += rand() % 1000;
+		if (data[i] != s)
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "scan", argc, argv);
+
+	size_t n = bench.arg(0, 1e9);
+
+	elem_t *data = nullptr;
+
+	bench.input(to_string(n));
+
+	bench.run([&](harness::benchmark &b) {
+		delete []data;
+		data = generate_data(n);
+
+		b.start_compute();
+		parallel_inclusive_scan(data, data + n, data,
+			elem_t(0), plus<elem_t>(), b.nthreads());
+		b.stop_compute();
+	});
+
+	bench.report(to_string(check(data, n)));
+
+	delete []data;
+	return 0;
+}
@@ -0,0 +1,71 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <functional>
+
+#include <staccato/parallel_sort.hpp>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace staccato;
+
+typedef int elem_t;
+
+size_t lenght = 0;
+elem_t *data = nullptr;
+long sum_before = 0;
+
+inline uint32_t xorshift_rand() {
+	static uint32_t x = 2463534242;
+	x ^= x >> 13;
+	x ^= x << 17;
+	x ^= x >> 5;
+	return x;
+}
+
+void generate_data(size_t n) {
+	lenght = n;
+	data = new elem_t[n];
+	sum_before = 0;
+	for (size_t i = 0; i < n; ++i) {
+		data[i] = xorshift_rand() % (n / 2);
+		sum_before += data[i];
+	}
+}
+
+bool check() {
+	long s = data[0];
+	for (size_t i = 1; i < lenght; ++i) {
+		s += data[i];
+		if (data[i - 1] > data[i])
+			return false;
+	}
+
+	return sum_before == s;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "sort", argc, argv);
+
+	size_t n = bench.arg(0, 8e7);
+
+	generate_data(n);
+	vector<elem_t> input(data, data + n);
+
+	bench.input(to_string(n));
+
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
+
+		b.start_compute();
+		parallel_sort(data, data + n, less<elem_t>(), b.nthreads());
+		b.stop_compute();
+	});
+
+	bench.report(to_string(check()));
+
+	delete []data;
+	return 0;
+}
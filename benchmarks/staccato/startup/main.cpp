@@ -0,0 +1,41 @@
+#include <iostream>
+#include <thread>
+
+#include <staccato/task.hpp>
+#include <staccato/scheduler.hpp>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace staccato;
+
+// Latency of scheduler construction and destruction. The compute phase is
+// a single empty root task, so startup and teardown are what's left.
+class EmptyTask: public task<EmptyTask>
+{
+public:
+	static constexpr size_t taskgraph_degree = 2;
+
+	void execute() {
+	}
+};
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("staccato", "startup", argc, argv);
+
+	bench.input("");
+
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
+		scheduler<EmptyTask> sh(b.nthreads());
+		b.start_compute();
+		sh.spawn(new(sh.root()) EmptyTask());
+		sh.wait();
+		b.stop_compute();
+	});
+
+	bench.report("");
+
+	return 0;
+}
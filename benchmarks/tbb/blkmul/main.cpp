@@ -4,7 +4,6 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 #include <cstring>
@@ -12,8 +11,9 @@
 #include <tbb/task.h>
 #include <tbb/task_scheduler_init.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace tbb;
 
 inline uint32_t xorshift_rand() {
@@ -326,22 +326,16 @@ bool check(Block *A, Block *B, Block *C, size_t n)
 
 int main(int argc, char *argv[])
 {
-	size_t log_n = 4;
-	size_t nthreads = 0;
+	harness::benchmark bench("tbb", "blkmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		log_n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t log_n = bench.arg(0, 4);
 
 	auto n = 1 << log_n;
 
-	cout << "Matrix dim: " << n * 16 << "\n";
+	cerr << "Matrix dim: " << n * 16 << "\n";
 	auto nblocks = n * n;
 
-	cout << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
+	cerr << "Data size:  " << 3 * nblocks * sizeof(Block) / 1024 << "Kb\n";
 
 	auto A = new Block[nblocks];
 	auto B = new Block[nblocks];
@@ -350,28 +344,24 @@ int main(int argc, char *argv[])
 	fill(A, nblocks);
 	fill(B, nblocks);
 
-	auto start = system_clock::now();
-
-	task_scheduler_init scheduler(nthreads);
+	bench.input(to_string(log_n));
 
-	auto root = new(task::allocate_root()) OperationTask(A, B, R, nblocks);
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
+		task_scheduler_init scheduler(b.nthreads());
+		b.start_compute();
 
-	task::spawn_root_and_wait(*root);
+		auto root = new(task::allocate_root()) OperationTask(A, B, R, nblocks);
+		task::spawn_root_and_wait(*root);
 
-	scheduler.terminate();
+		b.stop_compute();
+		scheduler.terminate();
+	});
 
-	auto stop = system_clock::now();
-
-	cout << "Scheduler:  tbb\n";
-	cout << "Benchmark:  blkmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << log_n << "\n";
-	cout << "Output:     " << check(A, B, R, nblocks) << "\n";
+	bench.report(to_string(check(A, B, R, nblocks)));
 
 	delete []A;
 	delete []B;
 	delete []R;
 	return 0;
 }
-
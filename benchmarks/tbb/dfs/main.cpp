@@ -1,13 +1,13 @@
 #include <iostream>
 #include <vector>
-#include <chrono>
 #include <thread>
 
 #include <tbb/task.h>
 #include <tbb/task_scheduler_init.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace tbb;
 
 class DFSTask: public task
@@ -49,38 +49,27 @@ private:
 
 int main(int argc, char *argv[])
 {
-	size_t depth = 8;
-	size_t breadth = 8;
-	unsigned long answer;
-	size_t nthreads = 0;
-
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		depth = atoi(argv[2]);
-	if (argc >= 4)
-		breadth = atoi(argv[3]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	harness::benchmark bench("tbb", "dfs", argc, argv);
 
-	auto start = system_clock::now();
-
-	task_scheduler_init scheduler(nthreads);
+	size_t depth = bench.arg(0, 8);
+	size_t breadth = bench.arg(1, 8);
+	unsigned long answer;
 
-	auto root = new(task::allocate_root()) DFSTask(depth, breadth, &answer);
+	bench.input(to_string(depth) + " " + to_string(breadth));
 
-	task::spawn_root_and_wait(*root);
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
+		task_scheduler_init scheduler(b.nthreads());
+		b.start_compute();
 
-	scheduler.terminate();
+		auto root = new(task::allocate_root()) DFSTask(depth, breadth, &answer);
+		task::spawn_root_and_wait(*root);
 
-	auto stop = system_clock::now();
+		b.stop_compute();
+		scheduler.terminate();
+	});
 
-	cout << "Scheduler:  tbb\n";
-	cout << "Benchmark:  dfs\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << depth << " " << breadth << "\n";
-	cout << "Output:     " << answer << "\n";
+	bench.report(to_string(answer));
 
 	return 0;
 }
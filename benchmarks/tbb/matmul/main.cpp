@@ -12,15 +12,15 @@
  */
 
 #include <iostream>
-#include <chrono>
 #include <thread>
 #include <cmath>
 
 #include <tbb/task.h>
 #include <tbb/task_scheduler_init.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace tbb;
 
 typedef float elem_t;
@@ -158,17 +158,12 @@ private:
 	bool add;
 };
 
-int main(int argc, char *argv[]) {
-	elem_t *A, *B, *C;
-	size_t n = 3000;
-	size_t nthreads = 0;
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("tbb", "matmul", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	elem_t *A, *B, *C;
+	size_t n = bench.arg(0, 3000);
 
 	A = new elem_t[n * n];
 	B = new elem_t[n * n];
@@ -176,29 +171,27 @@ int main(int argc, char *argv[]) {
 
 	fill(A, n);
 	fill(B, n);
-	zero(C, n);
-
-	auto start = system_clock::now();
 
-	task_scheduler_init scheduler(nthreads);
+	bench.input(to_string(n));
 
-	auto root = new(task::allocate_root()) MultTask(A, B, C, n, n, n, n, 0);
+	bench.run([&](harness::benchmark &b) {
+		zero(C, n);
 
-	task::spawn_root_and_wait(*root);
+		b.start_scheduler();
+		task_scheduler_init scheduler(b.nthreads());
+		b.start_compute();
 
-	scheduler.terminate();
+		auto root = new(task::allocate_root()) MultTask(A, B, C, n, n, n, n, 0);
+		task::spawn_root_and_wait(*root);
 
-	auto stop = system_clock::now();
+		b.stop_compute();
+		scheduler.terminate();
+	});
 
-	cout << "Scheduler:  tbb\n";
-	cout << "Benchmark:  matmul\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check(A, B, C, n) << "\n";
+	bench.report(to_string(check(A, B, C, n)));
 
 	delete []C;
 	delete []B;
-	delete []A; 
+	delete []A;
 	return 0;
 }
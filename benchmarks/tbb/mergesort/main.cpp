@@ -1,13 +1,14 @@
 #include <iostream>
-#include <chrono>
+#include <vector>
 #include <thread>
 #include <cstring>
 
 #include <tbb/task.h>
 #include <tbb/task_scheduler_init.h>
 
+#include "../../harness.hpp"
+
 using namespace std;
-using namespace chrono;
 using namespace tbb;
 
 typedef int elem_t;
@@ -110,36 +111,30 @@ private:
 
 int main(int argc, char *argv[])
 {
-	size_t n = 8e7;
-	size_t nthreads = 0;
+	harness::benchmark bench("tbb", "mergesort", argc, argv);
 
-	if (argc >= 2)
-		nthreads = atoi(argv[1]);
-	if (argc >= 3)
-		n = atoi(argv[2]);
-	if (nthreads == 0)
-		nthreads = thread::hardware_concurrency();
+	size_t n = bench.arg(0, 8e7);
 
 	generate_data(n);
+	vector<elem_t> input(data, data + n);
 
-	auto start = system_clock::now();
-
-	task_scheduler_init scheduler(nthreads);
+	bench.input(to_string(n));
 
-	auto root = new(task::allocate_root()) SortTask(0, n);
+	bench.run([&](harness::benchmark &b) {
+		copy(input.begin(), input.end(), data);
 
-	task::spawn_root_and_wait(*root);
+		b.start_scheduler();
+		task_scheduler_init scheduler(b.nthreads());
+		b.start_compute();
 
-	scheduler.terminate();
+		auto root = new(task::allocate_root()) SortTask(0, n);
+		task::spawn_root_and_wait(*root);
 
-	auto stop = system_clock::now();
+		b.stop_compute();
+		scheduler.terminate();
+	});
 
-	cout << "Scheduler:  tbb\n";
-	cout << "Benchmark:  mergesort\n";
-	cout << "Threads:    " << nthreads << "\n";
-	cout << "Time(us):   " << duration_cast<microseconds>(stop - start).count() << "\n";
-	cout << "Input:      " << n << "\n";
-	cout << "Output:     " << check() << "\n";
+	bench.report(to_string(check()));
 
 	return 0;
 }
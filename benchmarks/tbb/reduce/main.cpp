@@ -0,0 +1,77 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <functional>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_scheduler_init.h>
+
+#include "../../harness.hpp"
+
+using namespace std;
+using namespace tbb;
+
+typedef double elem_t;
+
+static const size_t grain = 4096;
+
+inline uint32_t xorshift_rand() {
+	static uint32_t x = 2463534242;
+	x ^= x >> 13;
+	x ^= x << 17;
+	x ^= x >> 5;
+	return x;
+}
+
+elem_t *generate_data(size_t n)
+{
+	auto data = new elem_t[n];
+	for (size_t i = 0; i < n; ++i)
+		data[i] = 1.0 / (1 + xorshift_rand() % 1000);
+	return data;
+}
+
+int main(int argc, char *argv[])
+{
+	harness::benchmark bench("tbb", "reduce", argc, argv);
+
+	size_t n = bench.arg(0, 1e8);
+	bool deterministic = bench.arg(1, 0);
+
+	auto data = generate_data(n);
+
+	auto map = [=](const blocked_range<size_t> &r, elem_t acc) {
+		for (size_t i = r.begin(); i != r.end(); ++i)
+			acc += data[i];
+		return acc;
+	};
+
+	elem_t answer;
+
+	bench.input(to_string(n) + " " + to_string(deterministic));
+
+	bench.run([&](harness::benchmark &b) {
+		b.start_scheduler();
+		task_scheduler_init scheduler(b.nthreads());
+		b.start_compute();
+
+		if (deterministic)
+			answer = parallel_deterministic_reduce(
+				blocked_range<size_t>(0, n, grain), 0.0, map, plus<elem_t>());
+		else
+			answer = parallel_reduce(
+				blocked_range<size_t>(0, n, grain), 0.0, map, plus<elem_t>());
+
+		b.stop_compute();
+		scheduler.terminate();
+	});
+
+	ostringstream output;
+	output << setprecision(17) << answer;
+	bench.report(output.str());
+
+	delete []data;
+	return 0;
+}
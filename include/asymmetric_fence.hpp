@@ -0,0 +1,68 @@
+#ifndef ASYMMETRIC_FENCE_HPP_QW3N8ZRC
+#define ASYMMETRIC_FENCE_HPP_QW3N8ZRC
+
+#include <atomic>
+
+#include "utils.hpp"
+
+#if STACCATO_ASYMMETRIC_FENCE
+
+#if !defined __linux__
+#	error "Asymmetric fences require Linux membarrier()"
+#endif
+
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace staccato
+{
+namespace internal
+{
+
+// A pair of fences that together act as a sequentially consistent fence.
+// light() is executed on the frequent path and costs only a compiler
+// barrier. heavy() is executed on the rare path: membarrier() makes every
+// running thread of the process execute a full memory barrier.
+//
+// If the kernel doesn't support expedited private membarrier, both sides
+// fall back to atomic_thread_fence(seq_cst).
+class asymmetric_fence
+{
+public:
+	static inline void light() {
+		if (available())
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+		else
+			atomic_fence_seq_cst();
+	}
+
+	static inline void heavy() {
+		if (available())
+			syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+		else
+			atomic_fence_seq_cst();
+	}
+
+private:
+	static inline bool available() {
+		static const bool registered = do_register();
+		return registered;
+	}
+
+	static bool do_register() {
+		long cmds = syscall(__NR_membarrier, MEMBARRIER_CMD_QUERY, 0);
+		if (cmds < 0 || !(cmds & MEMBARRIER_CMD_PRIVATE_EXPEDITED))
+			return false;
+
+		return syscall(__NR_membarrier,
+			MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+	}
+};
+
+} /* internal */
+} /* staccato */
+
+#endif // STACCATO_ASYMMETRIC_FENCE
+
+#endif /* end of include guard: ASYMMETRIC_FENCE_HPP_QW3N8ZRC */
@@ -31,16 +31,18 @@ public:
 		steal2_empty = 8,
 		dbg1         = 9,
 		dbg2         = 10,
+		publish      = 11,
 	};
 
 	void count(event_e e);
+	void count(event_e e, unsigned long n);
 
 	static void print_header();
 
 	void print(size_t id) const;
 
 private:
-	static const size_t m_nconsters = 11;
+	static const size_t m_nconsters = 12;
 	static const int m_cell_width = 9;
 
 	static const constexpr char* const m_events[] = { 
@@ -54,7 +56,8 @@ private:
 		"steal2!r",
 		"steal2!e",
 		"dbg1",
-		"dbg2"
+		"dbg2",
+		"publish"
 	};
 
 	unsigned long m_counters[m_nconsters];
@@ -73,6 +76,12 @@ void counter::count(event_e e)
 	m_counters[i]++;
 }
 
+void counter::count(event_e e, unsigned long n)
+{
+	auto i = static_cast<size_t>(e);
+	m_counters[i] += n;
+}
+
 void counter::print_header()
 {
 	FILE *fp = stdout;
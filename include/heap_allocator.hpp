@@ -0,0 +1,103 @@
+#ifndef HEAP_ALLOCATOR_HPP_R7DM2KQV
+#define HEAP_ALLOCATOR_HPP_R7DM2KQV
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "utils.hpp"
+
+namespace staccato
+{
+namespace internal
+{
+
+// Takes every object separately from the heap and frees them all on
+// destruction. It has the interface of lifo_allocator, but a worker's
+// deques end up scattered over memory. Useful to measure what the
+// contiguous LIFO placement gives.
+class heap_allocator
+{
+public:
+	heap_allocator(size_t page_size);
+
+	~heap_allocator();
+
+	template <typename T>
+	T *alloc();
+
+	template <typename T>
+	T *alloc_array(size_t lenght);
+
+	template <typename T>
+	T *alloc_extended(size_t size);
+
+	void *alloc(size_t alignment, size_t size);
+
+private:
+	struct block {
+		block *next;
+	};
+
+	block *m_head;
+};
+
+heap_allocator::heap_allocator(size_t)
+: m_head(nullptr)
+{ }
+
+heap_allocator::~heap_allocator()
+{
+	while (m_head) {
+		auto b = m_head;
+		m_head = b->next;
+		std::free(b);
+	}
+}
+
+template <typename T>
+T *heap_allocator::alloc()
+{
+	auto p = alloc(alignof(T), sizeof(T));
+	return reinterpret_cast<T *>(p);
+}
+
+template <typename T>
+T *heap_allocator::alloc_array(size_t lenght)
+{
+	auto p = alloc(alignof(T), sizeof(T) * lenght);
+	return reinterpret_cast<T *>(p);
+}
+
+template <typename T>
+T *heap_allocator::alloc_extended(size_t size)
+{
+	STACCATO_ASSERT(size >= sizeof(T), "Extended allocation is smaller than the object");
+	auto p = alloc(alignof(T), size);
+	return reinterpret_cast<T *>(p);
+}
+
+void *heap_allocator::alloc(size_t alignment, size_t size)
+{
+	if (alignment < alignof(block))
+		alignment = alignof(block);
+
+	// The block header takes the first aligned chunk
+	auto header = (sizeof(block) + alignment - 1) & ~(alignment - 1);
+	auto total = (header + size + alignment - 1) & ~(alignment - 1);
+
+	auto p = aligned_alloc(alignment, total);
+	if (!p)
+		throw std::bad_alloc();
+
+	auto b = new(p) block;
+	b->next = m_head;
+	m_head = b;
+
+	return reinterpret_cast<uint8_t *>(p) + header;
+}
+
+} /* internal */
+} /* staccato */
+
+#endif /* end of include guard: HEAP_ALLOCATOR_HPP_R7DM2KQV */
@@ -26,10 +26,31 @@ public:
 	template <typename T>
 	T *alloc_array(size_t lenght);
 
+	// Memory for T followed by trailing data, size bytes in total
+	template <typename T>
+	T *alloc_extended(size_t size);
+
+	void *alloc(size_t alignment, size_t size);
+
 	static inline size_t round_align(size_t to, size_t x) {
 		return (x + (to - 1)) & ~(to - 1);
 	}
 
+private:
+	class page;
+
+public:
+	// Position of the allocator. Rewinding to it releases everything
+	// allocated after mark() was called, pages are kept for reuse.
+	struct marker {
+		page *tail;
+		uint8_t *base;
+	};
+
+	marker mark() const;
+
+	void rewind(const marker &m);
+
 private:
 	class page {
 	public:
@@ -43,19 +64,21 @@ private:
 
 		page *get_next() const;
 
+		void reset();
+
 		static page *allocate_page(size_t alignment, size_t size);
 
 	private:
+		friend class lifo_allocator;
+
 		page *m_next;
-		size_t m_size_left;
 		void *m_stack;
-		void *m_base;
+		uint8_t *m_base;
+		uint8_t *m_end;
 	};
 
 	void inc_tail(size_t required_size);
 
-	void *alloc(size_t alignment, size_t size);
-
 	static const size_t m_page_alignment = 4 * (1 << 10);
 
 	const size_t m_page_size;
@@ -66,9 +89,9 @@ private:
 
 lifo_allocator::page::page(void *mem, size_t size)
 : m_next(nullptr)
-, m_size_left(size)
 , m_stack(mem)
 , m_base(reinterpret_cast<uint8_t *>(mem) + sizeof(page))
+, m_end(m_base + size)
 { }
 
 lifo_allocator::page::~page()
@@ -87,17 +110,22 @@ lifo_allocator::page *lifo_allocator::page::get_next() const
 
 void *lifo_allocator::page::alloc(size_t alignment, size_t size)
 {
-	auto p = std::align(alignment, size, m_base, m_size_left);
+	auto b = reinterpret_cast<uintptr_t>(m_base);
+	auto p = reinterpret_cast<uint8_t *>(round_align(alignment, b));
 
-	if (!p)
+	if (p + size > m_end)
 		return nullptr;
 
-	m_base = reinterpret_cast<uint8_t *>(m_base) + size;
-	m_size_left -= size;
+	m_base = p + size;
 
 	return p;
 }
 
+void lifo_allocator::page::reset()
+{
+	m_base = reinterpret_cast<uint8_t *>(m_stack) + sizeof(page);
+}
+
 lifo_allocator::page *lifo_allocator::page::allocate_page(
 	size_t alignment,
 	size_t size
@@ -142,13 +170,42 @@ T *lifo_allocator::alloc_array(size_t lenght)
 	return reinterpret_cast<T *>(p);
 }
 
+template <typename T>
+T *lifo_allocator::alloc_extended(size_t size)
+{
+	STACCATO_ASSERT(size >= sizeof(T), "Extended allocation is smaller than the object");
+	auto p = alloc(alignof(T), size);
+	return reinterpret_cast<T *>(p);
+}
+
+lifo_allocator::marker lifo_allocator::mark() const
+{
+	return {m_tail, m_tail->m_base};
+}
+
+void lifo_allocator::rewind(const marker &m)
+{
+	m_tail = m.tail;
+	m_tail->m_base = m.base;
+}
+
 void *lifo_allocator::alloc(size_t alignment, size_t size)
 {
 	void *ptr = m_tail->alloc(alignment, size);
 	if (ptr)
 		return ptr;
 
-	inc_tail(size);
+	// Pages left after a rewind
+	while (m_tail->get_next()) {
+		m_tail = m_tail->get_next();
+		m_tail->reset();
+
+		ptr = m_tail->alloc(alignment, size);
+		if (ptr)
+			return ptr;
+	}
+
+	inc_tail(alignment + size);
 
 	ptr = m_tail->alloc(alignment, size);
 	if (ptr)
@@ -160,8 +217,8 @@ void *lifo_allocator::alloc(size_t alignment, size_t size)
 void lifo_allocator::inc_tail(size_t required_size)
 {
 	auto sz = m_page_size;
-	if (required_size > sz)
-		sz = required_size;
+	if (required_size + sizeof(page) > sz)
+		sz = required_size + sizeof(page);
 
 	auto p = page::allocate_page(m_page_alignment, sz);
 
@@ -0,0 +1,542 @@
+#ifndef PARALLEL_RADIX_SORT_HPP_8M1TQZVC
+#define PARALLEL_RADIX_SORT_HPP_8M1TQZVC
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "utils.hpp"
+#include "task.hpp"
+#include "scheduler.hpp"
+
+namespace staccato
+{
+namespace internal
+{
+
+struct radix_no_value { };
+
+static const size_t radix_bits = 8;
+static const size_t radix_buckets = 1 << radix_bits;
+
+// State of one sorting step over a contiguous region. It lives on the stack
+// of the task that sorts the region and is shared by its children.
+template <typename Key, typename Value>
+struct radix_pass
+{
+	Key *src_keys;
+	Value *src_values;
+	Key *dst_keys;
+	Value *dst_values;
+
+	size_t n;
+	size_t block;
+	size_t nblocks;
+
+	size_t npasses;
+	size_t shift;
+
+	// nblocks x radix_buckets: block histograms, then block offsets
+	size_t *counts;
+
+	// nblocks x npasses x radix_buckets: histograms of every digit
+	uint32_t *digits;
+
+	// Bucket boundaries of an MSD partition step
+	size_t bucket_begin[radix_buckets + 1];
+
+	// Whether buckets must end up in dst after an MSD step
+	bool into_dst;
+};
+
+// One task type does all the work: it sorts a region, walks ranges of blocks
+// (histograms, scatters, copies), ranges of digits (offsets) and ranges of
+// buckets left by an MSD partition.
+template <typename Key, typename Value>
+class radix_task: public task<radix_task<Key, Value>>
+{
+public:
+	typedef radix_pass<Key, Value> pass_t;
+
+	enum mode_e {
+		sort_region  = 0,
+		analyze      = 1,
+		histogram    = 2,
+		scatter      = 3,
+		copy         = 4,
+		offsets      = 5,
+		buckets      = 6
+	};
+
+	static const bool has_values = !std::is_same<Value, radix_no_value>::value;
+
+	static const size_t min_block = 1 << 14;
+	static const size_t serial_cutoff = 64;
+
+	// Sorts n elements of keys (and values) using the same amount of scratch
+	// memory. The result is placed in scratch if into_scratch is set.
+	radix_task(
+		size_t nworkers,
+		Key *keys,
+		Value *values,
+		Key *scratch_keys,
+		Value *scratch_values,
+		size_t n,
+		size_t npasses,
+		bool into_scratch
+	)
+	: m_mode(sort_region)
+	, m_nworkers(nworkers)
+	, m_keys(keys)
+	, m_values(values)
+	, m_scratch_keys(scratch_keys)
+	, m_scratch_values(scratch_values)
+	, m_first(0)
+	, m_last(n)
+	, m_npasses(npasses)
+	, m_into_scratch(into_scratch)
+	, m_pass(nullptr)
+	{ }
+
+	// Processes blocks, digits or buckets [first, last) of a pass
+	radix_task(size_t nworkers, mode_e mode, pass_t *pass, size_t first, size_t last)
+	: m_mode(mode)
+	, m_nworkers(nworkers)
+	, m_keys(nullptr)
+	, m_values(nullptr)
+	, m_scratch_keys(nullptr)
+	, m_scratch_values(nullptr)
+	, m_first(first)
+	, m_last(last)
+	, m_npasses(0)
+	, m_into_scratch(false)
+	, m_pass(pass)
+	{ }
+
+	void execute() {
+		if (m_mode == sort_region) {
+			sort(m_keys, m_values, m_scratch_keys, m_scratch_values,
+				m_last, m_npasses, m_into_scratch);
+			return;
+		}
+
+		if (m_last - m_first > 1 && (m_mode != offsets
+				|| m_last - m_first > digits_grain)) {
+			size_t mid = m_first + (m_last - m_first) / 2;
+
+			this->spawn(new(this->child())
+				radix_task(m_nworkers, m_mode, m_pass, m_first, mid));
+			this->spawn(new(this->child())
+				radix_task(m_nworkers, m_mode, m_pass, mid, m_last));
+
+			this->wait();
+			return;
+		}
+
+		leaf(m_mode, m_pass, m_first, m_last);
+	}
+
+private:
+	static const size_t digits_grain = 16;
+
+	static const size_t wc_size = STACCATO_CACHE_SIZE / sizeof(Key) > 1
+		? STACCATO_CACHE_SIZE / sizeof(Key) : 1;
+
+	static inline size_t digit(Key k, size_t shift) {
+		return (k >> shift) & (radix_buckets - 1);
+	}
+
+	void for_each(mode_e mode, pass_t *pass, size_t first, size_t last) {
+		if (last - first == 1) {
+			leaf(mode, pass, first, last);
+			return;
+		}
+
+		this->spawn(new(this->child())
+			radix_task(m_nworkers, mode, pass, first, last));
+		this->wait();
+	}
+
+	void leaf(mode_e mode, pass_t *pass, size_t first, size_t last) {
+		switch (mode) {
+		case analyze:
+			analyze_block(pass, first);
+			break;
+		case histogram:
+			histogram_block(pass, first);
+			break;
+		case scatter:
+			scatter_block(pass, first);
+			break;
+		case copy:
+			copy_block(pass, first);
+			break;
+		case offsets:
+			offsets_digits(pass, first, last);
+			break;
+		case buckets:
+			sort_bucket(pass, first);
+			break;
+		default:
+			break;
+		}
+	}
+
+	void sort(
+		Key *keys,
+		Value *values,
+		Key *scratch_keys,
+		Value *scratch_values,
+		size_t n,
+		size_t npasses,
+		bool into_scratch
+	) {
+		if (n <= serial_cutoff) {
+			insertion_sort(keys, values, n);
+			if (into_scratch)
+				move(keys, values, scratch_keys, scratch_values, 0, n);
+			return;
+		}
+
+		pass_t pass;
+		pass.src_keys = keys;
+		pass.src_values = values;
+		pass.dst_keys = scratch_keys;
+		pass.dst_values = scratch_values;
+		pass.n = n;
+		pass.block = std::max(min_block, n / (4 * m_nworkers));
+		pass.nblocks = (n + pass.block - 1) / pass.block;
+		pass.npasses = npasses;
+		pass.shift = 0;
+
+		std::vector<size_t> counts(pass.nblocks * radix_buckets);
+		std::vector<uint32_t> digits(pass.nblocks * npasses * radix_buckets);
+		pass.counts = counts.data();
+		pass.digits = digits.data();
+
+		for_each(analyze, &pass, 0, pass.nblocks);
+
+		std::vector<size_t> totals(npasses * radix_buckets, 0);
+		for (size_t b = 0; b < pass.nblocks; ++b) {
+			auto d = pass.digits + b * npasses * radix_buckets;
+			for (size_t i = 0; i < npasses * radix_buckets; ++i)
+				totals[i] += d[i];
+		}
+
+		// A digit is worth a pass only if keys differ in it
+		std::vector<size_t> passes;
+		for (size_t p = 0; p < npasses; ++p) {
+			auto t = &totals[p * radix_buckets];
+			if (*std::max_element(t, t + radix_buckets) != n)
+				passes.push_back(p);
+		}
+
+		if (passes.empty()) {
+			if (into_scratch)
+				for_each(copy, &pass, 0, pass.nblocks);
+			return;
+		}
+
+		// Digits are taken from the analysis only for the first pass, while
+		// the blocks still hold the original keys
+		auto p0 = passes.front();
+		for (size_t b = 0; b < pass.nblocks; ++b) {
+			auto d = pass.digits + (b * npasses + p0) * radix_buckets;
+			std::copy(d, d + radix_buckets, pass.counts + b * radix_buckets);
+		}
+
+		auto top = passes.back();
+		auto t = &totals[top * radix_buckets];
+		bool skewed = *std::max_element(t, t + radix_buckets) > n / 2;
+
+		if (skewed && passes.size() > 1) {
+			msd(&pass, top, t, into_scratch);
+			return;
+		}
+
+		bool in_scratch = false;
+		for (size_t i = 0; i < passes.size(); ++i) {
+			auto p = passes[i];
+			pass.shift = p * radix_bits;
+
+			if (i > 0)
+				for_each(histogram, &pass, 0, pass.nblocks);
+
+			prefix_offsets(&pass, &totals[p * radix_buckets]);
+			for_each(scatter, &pass, 0, pass.nblocks);
+
+			std::swap(pass.src_keys, pass.dst_keys);
+			std::swap(pass.src_values, pass.dst_values);
+			in_scratch = !in_scratch;
+		}
+
+		if (in_scratch != into_scratch)
+			for_each(copy, &pass, 0, pass.nblocks);
+	}
+
+	// Partitions by the most significant digit and sorts every bucket
+	// independently on the remaining digits. Used when most keys share the
+	// top digit, since each bucket then skips the digits that are constant
+	// within it.
+	void msd(pass_t *pass, size_t top, const size_t *totals, bool into_scratch) {
+		for (size_t b = 0; b < pass->nblocks; ++b) {
+			auto d = pass->digits + (b * pass->npasses + top) * radix_buckets;
+			std::copy(d, d + radix_buckets, pass->counts + b * radix_buckets);
+		}
+
+		pass->shift = top * radix_bits;
+		prefix_offsets(pass, totals);
+		for_each(scatter, pass, 0, pass->nblocks);
+
+		pass->bucket_begin[0] = 0;
+		for (size_t d = 0; d < radix_buckets; ++d)
+			pass->bucket_begin[d + 1] = pass->bucket_begin[d] + totals[d];
+
+		pass->npasses = top;
+		pass->into_dst = into_scratch;
+
+		for_each(buckets, pass, 0, radix_buckets);
+	}
+
+	void sort_bucket(pass_t *pass, size_t d) {
+		auto b = pass->bucket_begin[d];
+		auto n = pass->bucket_begin[d + 1] - b;
+
+		if (n == 0)
+			return;
+
+		// After the partition the bucket is in dst, and src is its scratch
+		sort(
+			pass->dst_keys + b,
+			has_values ? pass->dst_values + b : nullptr,
+			pass->src_keys + b,
+			has_values ? pass->src_values + b : nullptr,
+			n,
+			pass->npasses,
+			!pass->into_dst
+		);
+	}
+
+	// Block offsets are computed digit by digit: offset of block b for digit
+	// d is the number of keys with smaller digits plus the number of keys
+	// with digit d in blocks before b. Digits are processed in parallel.
+	void prefix_offsets(pass_t *pass, const size_t *totals) {
+		size_t base = 0;
+		for (size_t d = 0; d < radix_buckets; ++d) {
+			pass->bucket_begin[d] = base;
+			base += totals[d];
+		}
+
+		if (pass->nblocks <= 4) {
+			offsets_digits(pass, 0, radix_buckets);
+			return;
+		}
+
+		this->spawn(new(this->child())
+			radix_task(m_nworkers, offsets, pass, 0, radix_buckets));
+		this->wait();
+	}
+
+	static void offsets_digits(pass_t *pass, size_t first, size_t last) {
+		for (size_t d = first; d < last; ++d) {
+			size_t run = pass->bucket_begin[d];
+			for (size_t b = 0; b < pass->nblocks; ++b) {
+				auto &c = pass->counts[b * radix_buckets + d];
+				auto x = c;
+				c = run;
+				run += x;
+			}
+		}
+	}
+
+	static void block_bounds(const pass_t *pass, size_t b, size_t *first, size_t *last) {
+		*first = b * pass->block;
+		*last = std::min(*first + pass->block, pass->n);
+	}
+
+	static void analyze_block(pass_t *pass, size_t b) {
+		size_t first, last;
+		block_bounds(pass, b, &first, &last);
+
+		auto np = pass->npasses;
+		auto d = pass->digits + b * np * radix_buckets;
+		memset(d, 0, np * radix_buckets * sizeof(*d));
+
+		for (size_t i = first; i < last; ++i) {
+			auto k = pass->src_keys[i];
+			for (size_t p = 0; p < np; ++p)
+				d[p * radix_buckets + digit(k, p * radix_bits)]++;
+		}
+	}
+
+	static void histogram_block(pass_t *pass, size_t b) {
+		size_t first, last;
+		block_bounds(pass, b, &first, &last);
+
+		auto c = pass->counts + b * radix_buckets;
+		std::fill(c, c + radix_buckets, 0);
+
+		for (size_t i = first; i < last; ++i)
+			c[digit(pass->src_keys[i], pass->shift)]++;
+	}
+
+	// Keys are staged per digit in cache-line sized buffers and written out
+	// a line at a time, instead of touching radix_buckets destination lines
+	// for every few keys.
+	static void scatter_block(pass_t *pass, size_t b) {
+		size_t first, last;
+		block_bounds(pass, b, &first, &last);
+
+		size_t pos[radix_buckets];
+		std::copy(pass->counts + b * radix_buckets,
+			pass->counts + (b + 1) * radix_buckets, pos);
+
+		Key wc_keys[radix_buckets][wc_size];
+		Value wc_values[has_values ? radix_buckets : 1][wc_size];
+		uint8_t fill[radix_buckets] = {};
+
+		auto shift = pass->shift;
+		auto src_keys = pass->src_keys;
+		auto dst_keys = pass->dst_keys;
+
+		for (size_t i = first; i < last; ++i) {
+			auto k = src_keys[i];
+			auto d = digit(k, shift);
+			auto f = fill[d];
+
+			wc_keys[d][f] = k;
+			if (has_values)
+				wc_values[d][f] = pass->src_values[i];
+
+			if (++f < wc_size) {
+				fill[d] = f;
+				continue;
+			}
+
+			std::copy(wc_keys[d], wc_keys[d] + wc_size, dst_keys + pos[d]);
+			if (has_values)
+				std::copy(wc_values[d], wc_values[d] + wc_size,
+					pass->dst_values + pos[d]);
+
+			pos[d] += wc_size;
+			fill[d] = 0;
+		}
+
+		for (size_t d = 0; d < radix_buckets; ++d) {
+			std::copy(wc_keys[d], wc_keys[d] + fill[d], dst_keys + pos[d]);
+			if (has_values)
+				std::copy(wc_values[d], wc_values[d] + fill[d],
+					pass->dst_values + pos[d]);
+		}
+	}
+
+	static void copy_block(pass_t *pass, size_t b) {
+		size_t first, last;
+		block_bounds(pass, b, &first, &last);
+
+		move(pass->src_keys, pass->src_values,
+			pass->dst_keys, pass->dst_values, first, last);
+	}
+
+	static void move(
+		const Key *keys,
+		const Value *values,
+		Key *dst_keys,
+		Value *dst_values,
+		size_t first,
+		size_t last
+	) {
+		std::copy(keys + first, keys + last, dst_keys + first);
+		if (has_values)
+			std::copy(values + first, values + last, dst_values + first);
+	}
+
+	static void insertion_sort(Key *keys, Value *values, size_t n) {
+		for (size_t i = 1; i < n; ++i) {
+			auto k = keys[i];
+			size_t j = i;
+
+			if (has_values) {
+				auto v = values[i];
+				for (; j > 0 && keys[j - 1] > k; --j) {
+					keys[j] = keys[j - 1];
+					values[j] = values[j - 1];
+				}
+				values[j] = v;
+			} else {
+				for (; j > 0 && keys[j - 1] > k; --j)
+					keys[j] = keys[j - 1];
+			}
+
+			keys[j] = k;
+		}
+	}
+
+	mode_e m_mode;
+	size_t m_nworkers;
+
+	Key *m_keys;
+	Value *m_values;
+	Key *m_scratch_keys;
+	Value *m_scratch_values;
+
+	size_t m_first;
+	size_t m_last;
+
+	size_t m_npasses;
+	bool m_into_scratch;
+
+	pass_t *m_pass;
+};
+
+template <typename Key, typename Value>
+void radix_sort(Key *keys, Value *values, size_t n, size_t nworkers)
+{
+	static_assert(std::is_integral<Key>::value && std::is_unsigned<Key>::value,
+		"Radix sort keys must be unsigned integers");
+
+	typedef radix_task<Key, Value> task_t;
+
+	if (n < 2)
+		return;
+
+	if (nworkers == 0)
+		nworkers = std::thread::hardware_concurrency();
+
+	std::unique_ptr<Key[]> scratch_keys(new Key[n]);
+	std::unique_ptr<Value[]> scratch_values(task_t::has_values ? new Value[n] : nullptr);
+
+	scheduler<task_t> sh(2, nworkers, 16);
+
+	sh.spawn(new(sh.root()) task_t(nworkers, keys, values,
+		scratch_keys.get(), scratch_values.get(), n, sizeof(Key), false));
+	sh.wait();
+}
+
+} /* internal */
+
+// LSD radix sort of unsigned integer keys by 8-bit digits. Digits which
+// are equal for all keys are skipped. If most keys fall into one bucket of
+// the top digit, it switches to an MSD partition followed by independent
+// sorts of every bucket.
+template <typename Key>
+void parallel_radix_sort(Key *keys, size_t n, size_t nworkers = 0)
+{
+	internal::radix_sort<Key, internal::radix_no_value>(
+		keys, nullptr, n, nworkers);
+}
+
+// Sorts keys and moves values along with them. The sort is stable.
+template <typename Key, typename Value>
+void parallel_radix_sort(Key *keys, Value *values, size_t n, size_t nworkers = 0)
+{
+	internal::radix_sort(keys, values, n, nworkers);
+}
+
+} /* staccato */
+
+#endif /* end of include guard: PARALLEL_RADIX_SORT_HPP_8M1TQZVC */
@@ -0,0 +1,143 @@
+#ifndef PARALLEL_REDUCE_HPP_7WJD2QLA
+#define PARALLEL_REDUCE_HPP_7WJD2QLA
+
+#include <cstddef>
+
+#include "utils.hpp"
+#include "range.hpp"
+#include "task.hpp"
+#include "scheduler.hpp"
+
+namespace staccato
+{
+namespace internal
+{
+
+template <typename V, typename Map, typename Combine>
+struct reduce_context
+{
+	const Map &map;
+	const Combine &combine;
+	const V &identity;
+	size_t grain;
+};
+
+// Partial results stay in the task object, i.e. in the parent's deque slot,
+// so the parent combines them after wait() without any extra allocation.
+template <typename V, typename Map, typename Combine>
+class reduce_task: public task<reduce_task<V, Map, Combine>>
+{
+public:
+	typedef reduce_context<V, Map, Combine> context_t;
+
+	reduce_task(const context_t *ctx, size_t begin, size_t end)
+	: m_ctx(ctx)
+	, m_begin(begin)
+	, m_end(end)
+	, m_result(ctx->identity)
+	{ }
+
+	void execute() {
+		if (m_end - m_begin <= m_ctx->grain) {
+			V acc = m_ctx->identity;
+			for (size_t i = m_begin; i < m_end; ++i)
+				acc = m_ctx->combine(acc, m_ctx->map(i));
+
+			m_result = acc;
+			return;
+		}
+
+		size_t mid = m_begin + (m_end - m_begin) / 2;
+
+		auto l = new(this->child()) reduce_task(m_ctx, m_begin, mid);
+		this->spawn(l);
+
+		auto r = new(this->child()) reduce_task(m_ctx, mid, m_end);
+		this->spawn(r);
+
+		this->wait();
+
+		m_result = m_ctx->combine(l->m_result, r->m_result);
+	}
+
+	const V &result() const {
+		return m_result;
+	}
+
+private:
+	const context_t *m_ctx;
+	size_t m_begin;
+	size_t m_end;
+	V m_result;
+};
+
+template <typename V, typename Map, typename Combine>
+V reduce(
+	const range &r,
+	size_t grain,
+	const V &identity,
+	const Map &map,
+	const Combine &combine,
+	size_t nworkers
+) {
+	typedef reduce_task<V, Map, Combine> task_t;
+
+	if (r.empty())
+		return identity;
+
+	typename task_t::context_t ctx = {map, combine, identity, grain};
+
+	range leafs(r.begin(), r.end(), grain);
+
+	scheduler<task_t> sh(2, nworkers, leafs.depth() + 1);
+
+	auto root = new(sh.root()) task_t(&ctx, r.begin(), r.end());
+	sh.spawn(root);
+	sh.wait();
+
+	return root->result();
+}
+
+} /* internal */
+
+// Reduces map(i) over i in the range with an associative combine.
+// Leaves are sized from both the range and the number of workers, so the
+// combine tree (and rounding of floating-point results) may differ between
+// runs with different thread counts.
+template <typename V, typename Map, typename Combine>
+V parallel_reduce(
+	const range &r,
+	V identity,
+	Map map,
+	Combine combine,
+	size_t nworkers = 0
+) {
+	static const size_t leafs_per_worker = 8;
+
+	if (nworkers == 0)
+		nworkers = std::thread::hardware_concurrency();
+
+	size_t grain = r.size() / (nworkers * leafs_per_worker);
+	if (grain < r.grain())
+		grain = r.grain();
+
+	return internal::reduce(r, grain, identity, map, combine, nworkers);
+}
+
+// Same as parallel_reduce(), but the split points depend only on the range
+// and its grain. Every run combines partial results in the same order, so
+// the result is bit-reproducible for any number of workers.
+template <typename V, typename Map, typename Combine>
+V deterministic_parallel_reduce(
+	const range &r,
+	V identity,
+	Map map,
+	Combine combine,
+	size_t nworkers = 0
+) {
+	return internal::reduce(r, r.grain(), identity, map, combine, nworkers);
+}
+
+} /* staccato */
+
+#endif /* end of include guard: PARALLEL_REDUCE_HPP_7WJD2QLA */
@@ -0,0 +1,349 @@
+#ifndef PARALLEL_SCAN_HPP_R5NC0WXE
+#define PARALLEL_SCAN_HPP_R5NC0WXE
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "utils.hpp"
+#include "range.hpp"
+#include "task.hpp"
+#include "scheduler.hpp"
+
+namespace staccato
+{
+namespace internal
+{
+
+template <typename T, typename Op>
+void serial_scan(
+	const T *in,
+	size_t n,
+	T *out,
+	T carry,
+	const Op &op,
+	bool inclusive
+) {
+	if (inclusive) {
+		for (size_t i = 0; i < n; ++i) {
+			carry = op(carry, in[i]);
+			out[i] = carry;
+		}
+	} else {
+		for (size_t i = 0; i < n; ++i) {
+			T x = in[i];
+			out[i] = carry;
+			carry = op(carry, x);
+		}
+	}
+}
+
+template <typename T, typename Op>
+inline void scan_block(
+	const T *in,
+	size_t n,
+	T *out,
+	const T &carry,
+	const Op &op,
+	bool inclusive
+) {
+	serial_scan(in, n, out, carry, op, inclusive);
+}
+
+#if defined __GNUC__
+
+#if defined __AVX2__
+#	define STACCATO_SIMD_BYTES 32
+#else
+#	define STACCATO_SIMD_BYTES 16
+#endif
+
+// Only used when 4 elements fill at most one native vector register,
+// otherwise the cross-register shuffles make it slower than a scalar loop
+template <typename T>
+struct simd_scan_enabled
+{
+	static const bool value = std::is_arithmetic<T>::value
+		&& (sizeof(T) == 4 || sizeof(T) == 8)
+		&& 4 * sizeof(T) <= STACCATO_SIMD_BYTES;
+};
+
+template <size_t S>
+struct simd_mask_elem { };
+
+template <>
+struct simd_mask_elem<4> { typedef int32_t type; };
+
+template <>
+struct simd_mask_elem<8> { typedef int64_t type; };
+
+// Additive scans of arithmetic types are done 4 elements at a time: an
+// in-register log-step scan followed by adding the broadcast carry. For
+// floating-point types the rounding differs slightly from a serial loop.
+template <typename T>
+struct simd_scan
+{
+	typedef T vec_t __attribute__((vector_size(4 * sizeof(T))));
+	typedef typename simd_mask_elem<sizeof(T)>::type mask_elem_t;
+	typedef mask_elem_t mask_t __attribute__((vector_size(4 * sizeof(T))));
+
+	static void scan(
+		const T *in,
+		size_t n,
+		T *out,
+		T carry,
+		bool inclusive
+	) {
+		const vec_t zero = {};
+		vec_t c = zero + carry;
+
+#if !defined __clang__
+		const mask_t m1 = {4, 0, 1, 2};
+		const mask_t m2 = {4, 5, 0, 1};
+#	define STACCATO_SHIFT1(x) __builtin_shuffle((x), zero, m1)
+#	define STACCATO_SHIFT2(x) __builtin_shuffle((x), zero, m2)
+#else
+#	define STACCATO_SHIFT1(x) __builtin_shufflevector(zero, (x), 0, 4, 5, 6)
+#	define STACCATO_SHIFT2(x) __builtin_shufflevector(zero, (x), 0, 1, 4, 5)
+#endif
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			vec_t x;
+			memcpy(&x, in + i, sizeof(x));
+
+			x += STACCATO_SHIFT1(x);
+			x += STACCATO_SHIFT2(x);
+
+			vec_t r = (inclusive ? x : STACCATO_SHIFT1(x)) + c;
+			memcpy(out + i, &r, sizeof(r));
+
+			c += x[3];
+		}
+
+#undef STACCATO_SHIFT1
+#undef STACCATO_SHIFT2
+
+		serial_scan(in + i, n - i, out + i, c[0], std::plus<T>(), inclusive);
+	}
+};
+
+template <typename T>
+inline typename std::enable_if<simd_scan_enabled<T>::value>::type scan_block(
+	const T *in,
+	size_t n,
+	T *out,
+	const T &carry,
+	const std::plus<T> &,
+	bool inclusive
+) {
+	simd_scan<T>::scan(in, n, out, carry, inclusive);
+}
+
+#endif // __GNUC__
+
+template <typename T, typename Op>
+struct scan_context
+{
+	const T *in;
+	T *out;
+	size_t n;
+	size_t block;
+	const T &init;
+	const Op &op;
+	bool inclusive;
+
+	// partial[mid] holds the total of the left half of the node split at mid
+	T *partial;
+};
+
+// Upsweep computes block totals bottom-up and stores left-half totals of
+// every inner node. Downsweep then walks the same tree top-down passing the
+// carry into each block, so no serial pass over the block totals is needed.
+template <typename T, typename Op>
+class scan_task: public task<scan_task<T, Op>>
+{
+public:
+	typedef scan_context<T, Op> context_t;
+
+	scan_task(
+		const context_t *ctx,
+		size_t first_block,
+		size_t last_block,
+		bool downsweep,
+		const T &carry
+	)
+	: m_ctx(ctx)
+	, m_first(first_block)
+	, m_last(last_block)
+	, m_downsweep(downsweep)
+	, m_value(carry)
+	{ }
+
+	void execute() {
+		if (m_downsweep)
+			down();
+		else
+			up();
+	}
+
+	const T &total() const {
+		return m_value;
+	}
+
+private:
+	void up() {
+		if (m_last - m_first == 1) {
+			auto b = block_begin(m_first);
+			auto e = block_end(m_first);
+
+			T acc = m_ctx->in[b];
+			for (size_t i = b + 1; i < e; ++i)
+				acc = m_ctx->op(acc, m_ctx->in[i]);
+
+			m_value = acc;
+			return;
+		}
+
+		size_t mid = m_first + (m_last - m_first) / 2;
+		auto &init = m_ctx->init;
+
+		auto l = new(this->child()) scan_task(m_ctx, m_first, mid, false, init);
+		this->spawn(l);
+
+		auto r = new(this->child()) scan_task(m_ctx, mid, m_last, false, init);
+		this->spawn(r);
+
+		this->wait();
+
+		m_ctx->partial[mid] = l->m_value;
+		m_value = m_ctx->op(l->m_value, r->m_value);
+	}
+
+	void down() {
+		if (m_last - m_first == 1) {
+			auto b = block_begin(m_first);
+			auto e = block_end(m_first);
+
+			scan_block(
+				m_ctx->in + b,
+				e - b,
+				m_ctx->out + b,
+				m_value,
+				m_ctx->op,
+				m_ctx->inclusive
+			);
+			return;
+		}
+
+		size_t mid = m_first + (m_last - m_first) / 2;
+		T right_carry = m_ctx->op(m_value, m_ctx->partial[mid]);
+
+		this->spawn(new(this->child())
+			scan_task(m_ctx, m_first, mid, true, m_value));
+		this->spawn(new(this->child())
+			scan_task(m_ctx, mid, m_last, true, right_carry));
+
+		this->wait();
+	}
+
+	size_t block_begin(size_t b) const {
+		return b * m_ctx->block;
+	}
+
+	size_t block_end(size_t b) const {
+		auto e = (b + 1) * m_ctx->block;
+		return e < m_ctx->n ? e : m_ctx->n;
+	}
+
+	const context_t *m_ctx;
+	size_t m_first;
+	size_t m_last;
+	bool m_downsweep;
+	T m_value;
+};
+
+template <typename T>
+inline size_t scan_block_size()
+{
+	// Input and output of a block should both stay in L2 between passes
+	size_t s = STACCATO_L2_CACHE_SIZE / (2 * sizeof(T));
+	return s ? s : 1;
+}
+
+template <typename T, typename Op>
+void scan(
+	const T *first,
+	const T *last,
+	T *out,
+	const T &init,
+	const Op &op,
+	bool inclusive,
+	size_t nworkers
+) {
+	typedef scan_task<T, Op> task_t;
+
+	size_t n = last - first;
+	if (n == 0)
+		return;
+
+	size_t block = scan_block_size<T>();
+	size_t nblocks = (n + block - 1) / block;
+
+	if (nblocks == 1) {
+		scan_block(first, n, out, init, op, inclusive);
+		return;
+	}
+
+	auto partial = new T[nblocks];
+
+	typename task_t::context_t ctx = {
+		first, out, n, block, init, op, inclusive, partial
+	};
+
+	range blocks(0, nblocks);
+
+	scheduler<task_t> sh(2, nworkers, blocks.depth() + 1);
+
+	sh.spawn(new(sh.root()) task_t(&ctx, 0, nblocks, false, init));
+	sh.wait();
+
+	sh.spawn(new(sh.root()) task_t(&ctx, 0, nblocks, true, init));
+	sh.wait();
+
+	delete []partial;
+}
+
+} /* internal */
+
+// out[i] = init op first[0] op ... op first[i]; out may be equal to first
+template <typename T, typename Op = std::plus<T>>
+void parallel_inclusive_scan(
+	const T *first,
+	const T *last,
+	T *out,
+	T init = T(),
+	Op op = Op(),
+	size_t nworkers = 0
+) {
+	internal::scan(first, last, out, init, op, true, nworkers);
+}
+
+// out[i] = init op first[0] op ... op first[i - 1]; out may be equal to first
+template <typename T, typename Op = std::plus<T>>
+void parallel_exclusive_scan(
+	const T *first,
+	const T *last,
+	T *out,
+	T init = T(),
+	Op op = Op(),
+	size_t nworkers = 0
+) {
+	internal::scan(first, last, out, init, op, false, nworkers);
+}
+
+} /* staccato */
+
+#endif /* end of include guard: PARALLEL_SCAN_HPP_R5NC0WXE */
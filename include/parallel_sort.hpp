@@ -0,0 +1,189 @@
+#ifndef PARALLEL_SORT_HPP_D1ZK6HUB
+#define PARALLEL_SORT_HPP_D1ZK6HUB
+
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+
+#include "utils.hpp"
+#include "range.hpp"
+#include "task.hpp"
+#include "scheduler.hpp"
+
+namespace staccato
+{
+namespace internal
+{
+
+template <typename Compare>
+struct sort_context
+{
+	const Compare &comp;
+	size_t sort_cutoff;
+	size_t merge_cutoff;
+};
+
+// Merge sort which alternates the roles of the input array and the
+// temporary buffer on every level (ping-pong), so sorted halves are never
+// copied back. Merges are split in two by a binary search in the smaller
+// run, so the top-level merge is parallel as well.
+template <typename T, typename Compare>
+class sort_task: public task<sort_task<T, Compare>>
+{
+public:
+	typedef sort_context<Compare> context_t;
+
+	// Sorts [data, data + n). If into_tmp is set the result is placed in
+	// [tmp, tmp + n), otherwise in the original location.
+	sort_task(const context_t *ctx, T *data, T *tmp, size_t n, bool into_tmp)
+	: m_ctx(ctx)
+	, m_merge(false)
+	, m_into_tmp(into_tmp)
+	, m_a(data)
+	, m_na(n)
+	, m_b(nullptr)
+	, m_nb(0)
+	, m_out(tmp)
+	{ }
+
+	// Merges [a, a + na) and [b, b + nb) into out
+	sort_task(const context_t *ctx, T *a, size_t na, T *b, size_t nb, T *out)
+	: m_ctx(ctx)
+	, m_merge(true)
+	, m_into_tmp(false)
+	, m_a(a)
+	, m_na(na)
+	, m_b(b)
+	, m_nb(nb)
+	, m_out(out)
+	{ }
+
+	void execute() {
+		if (m_merge)
+			merge(m_a, m_na, m_b, m_nb, m_out);
+		else
+			sort();
+	}
+
+private:
+	void sort() {
+		auto data = m_a;
+		auto tmp = m_out;
+		auto n = m_na;
+
+		if (n <= m_ctx->sort_cutoff) {
+			std::sort(data, data + n, m_ctx->comp);
+
+			if (m_into_tmp)
+				std::move(data, data + n, tmp);
+
+			return;
+		}
+
+		auto nl = n / 2;
+		auto nr = n - nl;
+
+		this->spawn(new(this->child())
+			sort_task(m_ctx, data, tmp, nl, !m_into_tmp));
+		this->spawn(new(this->child())
+			sort_task(m_ctx, data + nl, tmp + nl, nr, !m_into_tmp));
+
+		this->wait();
+
+		if (m_into_tmp)
+			merge(data, nl, data + nl, nr, tmp);
+		else
+			merge(tmp, nl, tmp + nl, nr, data);
+	}
+
+	void merge(T *a, size_t na, T *b, size_t nb, T *out) {
+		auto &comp = m_ctx->comp;
+
+		if (na + nb <= m_ctx->merge_cutoff) {
+			std::merge(
+				std::make_move_iterator(a),
+				std::make_move_iterator(a + na),
+				std::make_move_iterator(b),
+				std::make_move_iterator(b + nb),
+				out,
+				comp
+			);
+			return;
+		}
+
+		// Elements of a equal to the pivot stay before elements of b
+		size_t ma, mb;
+		if (na >= nb) {
+			ma = na / 2;
+			mb = std::lower_bound(b, b + nb, a[ma], comp) - b;
+		} else {
+			mb = nb / 2;
+			ma = std::upper_bound(a, a + na, b[mb], comp) - a;
+		}
+
+		this->spawn(new(this->child())
+			sort_task(m_ctx, a, ma, b, mb, out));
+		this->spawn(new(this->child())
+			sort_task(m_ctx, a + ma, na - ma, b + mb, nb - mb, out + ma + mb));
+
+		this->wait();
+	}
+
+	const context_t *m_ctx;
+
+	bool m_merge;
+	bool m_into_tmp;
+
+	T *m_a;
+	size_t m_na;
+	T *m_b;
+	size_t m_nb;
+	T *m_out;
+};
+
+} /* internal */
+
+// Sorts [first, last) in contiguous storage. Needs n elements of extra
+// memory for the ping-pong buffer.
+template <typename It, typename Compare>
+void parallel_sort(It first, It last, Compare comp, size_t nworkers = 0)
+{
+	typedef typename std::iterator_traits<It>::value_type T;
+	typedef internal::sort_task<T, Compare> task_t;
+
+	static const size_t sort_cutoff = 8192;
+	static const size_t merge_cutoff = 8192;
+
+	size_t n = last - first;
+
+	if (n <= sort_cutoff) {
+		std::sort(first, last, comp);
+		return;
+	}
+
+	T *data = &*first;
+	std::unique_ptr<T[]> tmp(new T[n]);
+
+	typename task_t::context_t ctx = {comp, sort_cutoff, merge_cutoff};
+
+	// Each level of the sort tree is followed by a merge tree of the same height
+	range leafs(0, n, sort_cutoff);
+
+	scheduler<task_t> sh(2, nworkers, 2 * leafs.depth() + 1);
+
+	sh.spawn(new(sh.root()) task_t(&ctx, data, tmp.get(), n, false));
+	sh.wait();
+}
+
+template <typename It>
+void parallel_sort(It first, It last)
+{
+	typedef typename std::iterator_traits<It>::value_type T;
+	parallel_sort(first, last, std::less<T>());
+}
+
+} /* staccato */
+
+#endif /* end of include guard: PARALLEL_SORT_HPP_D1ZK6HUB */
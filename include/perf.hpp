@@ -0,0 +1,245 @@
+#ifndef PERF_HPP_4GZM1QWE
+#define PERF_HPP_4GZM1QWE
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "utils.hpp"
+
+#if STACCATO_PERF
+
+#if !defined __linux__
+#	error "Performance counters require Linux perf_event_open()"
+#endif
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif // STACCATO_PERF
+
+namespace staccato
+{
+
+// Performance counters of a worker over code of one kind. Events the
+// kernel or the hardware doesn't provide stay 0.
+struct perf_values
+{
+	unsigned long cycles;
+	unsigned long instructions;
+	unsigned long llc_misses;
+	unsigned long dtlb_misses;
+	unsigned long context_switches;
+
+	perf_values &operator+=(const perf_values &o) {
+		cycles += o.cycles;
+		instructions += o.instructions;
+		llc_misses += o.llc_misses;
+		dtlb_misses += o.dtlb_misses;
+		context_switches += o.context_switches;
+		return *this;
+	}
+};
+
+namespace internal
+{
+
+inline void print_perf_header()
+{
+	FILE *fp = stdout;
+
+	fprintf(fp, "[STACCATO] w# | phase |%14s |%14s |%11s |%11s |%9s |\n",
+		"cycles", "instructions", "LLC miss", "dTLB miss", "ctx sw");
+}
+
+inline void print_perf(size_t id, const char *phase, const perf_values &v)
+{
+	FILE *fp = stdout;
+
+	fprintf(fp, "[STACCATO]%3lu | %5s |%14lu |%14lu |%11lu |%11lu |%9lu |\n",
+		id, phase, v.cycles, v.instructions, v.llc_misses, v.dtlb_misses,
+		v.context_switches);
+}
+
+#if STACCATO_PERF
+
+// perf_event_open() counters of the thread that opens them, read as one
+// group. Each read adds the difference from the previous one to the phase
+// the thread was in, so the counts are split between task code and
+// scheduler code. Only the owner reads; the totals are relaxed atomics so
+// that they can be read by other threads at any time.
+class STACCATO_ALIGN perf_counters
+{
+public:
+	enum phase_e {
+		in_task      = 0,
+		in_scheduler = 1,
+		outside      = 2
+	};
+
+	perf_counters();
+	~perf_counters();
+
+	perf_counters(const perf_counters &) = delete;
+	perf_counters &operator=(const perf_counters &) = delete;
+
+	// Starts counting for the calling thread, outside of any phase
+	void open();
+
+	// Attributes the counts since the last call to the current phase
+	void enter(phase_e phase);
+
+	perf_values snapshot(phase_e phase) const;
+
+private:
+	static const size_t m_nevents = 5;
+
+	enum event_e {
+		cycles           = 0,
+		instructions     = 1,
+		llc_misses       = 2,
+		dtlb_misses      = 3,
+		context_switches = 4
+	};
+
+	void open_event(event_e e, uint32_t type, uint64_t config, bool kernel);
+
+	void read_group(uint64_t *values);
+
+	int m_leader;
+	int m_fds[m_nevents];
+
+	// Position of each event in the group read, or -1
+	int m_slots[m_nevents];
+	size_t m_nopen;
+
+	phase_e m_phase;
+	uint64_t m_last[m_nevents];
+	std::atomic_ulong m_totals[2][m_nevents];
+};
+
+perf_counters::perf_counters()
+: m_leader(-1)
+, m_nopen(0)
+, m_phase(outside)
+{
+	for (size_t i = 0; i < m_nevents; ++i) {
+		m_fds[i] = -1;
+		m_slots[i] = -1;
+		m_last[i] = 0;
+		store_relaxed(m_totals[in_task][i], 0);
+		store_relaxed(m_totals[in_scheduler][i], 0);
+	}
+}
+
+perf_counters::~perf_counters()
+{
+	for (size_t i = 0; i < m_nevents; ++i)
+		if (m_fds[i] >= 0)
+			close(m_fds[i]);
+}
+
+void perf_counters::open()
+{
+	// Hardware events of user space code only. Context switches happen in
+	// the kernel and aren't seen without it.
+	open_event(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, false);
+	open_event(instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, false);
+	open_event(llc_misses, PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_LL
+		| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+		| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), false);
+	open_event(dtlb_misses, PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_DTLB
+		| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+		| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), false);
+	open_event(context_switches, PERF_TYPE_SOFTWARE,
+		PERF_COUNT_SW_CONTEXT_SWITCHES, true);
+
+	if (m_leader < 0)
+		return;
+
+	ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+	read_group(m_last);
+}
+
+void perf_counters::open_event(event_e e, uint32_t type, uint64_t config, bool kernel)
+{
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = m_leader < 0;
+	attr.exclude_kernel = !kernel;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP;
+
+	int fd = syscall(__NR_perf_event_open, &attr, 0, -1, m_leader, 0);
+	if (fd < 0)
+		return;
+
+	if (m_leader < 0)
+		m_leader = fd;
+
+	m_fds[e] = fd;
+	m_slots[e] = m_nopen++;
+}
+
+inline void perf_counters::read_group(uint64_t *values)
+{
+	// Number of events followed by their values in opening order
+	uint64_t buf[1 + m_nevents];
+
+	if (m_leader < 0 || read(m_leader, buf, sizeof(buf)) <= 0)
+		return;
+
+	for (size_t i = 0; i < m_nevents; ++i)
+		if (m_slots[i] >= 0)
+			values[i] = buf[1 + m_slots[i]];
+}
+
+inline void perf_counters::enter(phase_e phase)
+{
+	if (m_leader < 0)
+		return;
+
+	uint64_t now[m_nevents];
+	memcpy(now, m_last, sizeof(now));
+	read_group(now);
+
+	if (m_phase != outside) {
+		for (size_t i = 0; i < m_nevents; ++i) {
+			auto &t = m_totals[m_phase][i];
+			store_relaxed(t, load_relaxed(t) + (now[i] - m_last[i]));
+		}
+	}
+
+	memcpy(m_last, now, sizeof(now));
+	m_phase = phase;
+}
+
+perf_values perf_counters::snapshot(phase_e phase) const
+{
+	perf_values v;
+	v.cycles = load_relaxed(m_totals[phase][cycles]);
+	v.instructions = load_relaxed(m_totals[phase][instructions]);
+	v.llc_misses = load_relaxed(m_totals[phase][llc_misses]);
+	v.dtlb_misses = load_relaxed(m_totals[phase][dtlb_misses]);
+	v.context_switches = load_relaxed(m_totals[phase][context_switches]);
+	return v;
+}
+
+#endif // STACCATO_PERF
+
+} /* internal */
+} /* staccato */
+
+#endif /* end of include guard: PERF_HPP_4GZM1QWE */
@@ -0,0 +1,179 @@
+#ifndef POLICY_HPP_J4XW8NCE
+#define POLICY_HPP_J4XW8NCE
+
+#include <cstddef>
+#include <thread>
+
+#include "utils.hpp"
+#include "lifo_allocator.hpp"
+#include "heap_allocator.hpp"
+
+namespace staccato
+{
+
+// Victim selection. A worker owns one object, constructed with its id, and
+// calls next(n) to get the index of the next victim out of n.
+
+class random_victim
+{
+public:
+	random_victim(size_t)
+	{ }
+
+	size_t next(size_t nvictims) {
+		return internal::xorshift_rand() % nvictims;
+	}
+};
+
+// Workers start at different victims, so they don't all go after the same
+// one at once
+class round_robin_victim
+{
+public:
+	round_robin_victim(size_t id): m_last(id)
+	{ }
+
+	size_t next(size_t nvictims) {
+		if (++m_last >= nvictims)
+			m_last = 0;
+		return m_last;
+	}
+
+private:
+	size_t m_last;
+};
+
+// Idle strategies. idle() is called after a failed steal, reset() after a
+// successful one.
+
+class yield_idle
+{
+public:
+	void idle() { std::this_thread::yield(); }
+	void reset() { }
+};
+
+class spin_idle
+{
+public:
+	void idle() { internal::cpu_relax(); }
+	void reset() { }
+};
+
+class backoff_idle
+{
+public:
+	backoff_idle(): m_spins(1)
+	{ }
+
+	void idle() {
+		if (m_spins > max_spins) {
+			std::this_thread::yield();
+			return;
+		}
+
+		for (size_t i = 0; i < m_spins; ++i)
+			internal::cpu_relax();
+
+		m_spins *= 2;
+	}
+
+	void reset() { m_spins = 1; }
+
+private:
+	static const size_t max_spins = 1024;
+
+	size_t m_spins;
+};
+
+// Deque variants, see STACCATO_DEQUE in utils.hpp
+
+struct shared_deque
+{
+	static const int variant = STACCATO_DEQUE_SHARED;
+};
+
+struct private_deque
+{
+	static const int variant = STACCATO_DEQUE_PRIVATE;
+};
+
+struct split_deque
+{
+	static const int variant = STACCATO_DEQUE_SPLIT;
+};
+
+// Allocators of deques and other per-worker memory
+
+using internal::lifo_allocator;
+using internal::heap_allocator;
+
+template <
+	typename Victim,
+	typename Idle,
+	typename Deque,
+	typename Allocator
+>
+struct policy
+{
+	typedef Victim victim;
+	typedef Idle idle;
+	typedef Deque deque;
+	typedef Allocator allocator;
+};
+
+typedef policy<
+#if STACCATO_VICTIM == STACCATO_VICTIM_ROUND_ROBIN
+	round_robin_victim,
+#else
+	random_victim,
+#endif
+#if STACCATO_IDLE == STACCATO_IDLE_SPIN
+	spin_idle,
+#elif STACCATO_IDLE == STACCATO_IDLE_BACKOFF
+	backoff_idle,
+#else
+	yield_idle,
+#endif
+#if STACCATO_DEQUE == STACCATO_DEQUE_PRIVATE
+	private_deque,
+#elif STACCATO_DEQUE == STACCATO_DEQUE_SPLIT
+	split_deque,
+#else
+	shared_deque,
+#endif
+#if STACCATO_ALLOCATOR == STACCATO_ALLOCATOR_HEAP
+	heap_allocator
+#else
+	lifo_allocator
+#endif
+> default_policy;
+
+namespace internal
+{
+
+template <typename T>
+struct void_type
+{
+	typedef void type;
+};
+
+// Policy declared by T as a scheduler_policy member type, otherwise the
+// default one
+template <typename T, typename = void>
+struct policy_of
+{
+	typedef default_policy type;
+};
+
+template <typename T>
+struct policy_of<T, typename void_type<typename T::scheduler_policy>::type>
+{
+	typedef typename T::scheduler_policy type;
+};
+
+} /* internal */
+
+} /* staccato */
+
+#endif /* end of include guard: POLICY_HPP_J4XW8NCE */
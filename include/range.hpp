@@ -0,0 +1,45 @@
+#ifndef RANGE_HPP_Q3VMZ8XK
+#define RANGE_HPP_Q3VMZ8XK
+
+#include <cstddef>
+
+namespace staccato
+{
+
+class range
+{
+public:
+	range(size_t begin, size_t end, size_t grain = 1)
+	: m_begin(begin)
+	, m_end(end < begin ? begin : end)
+	, m_grain(grain ? grain : 1)
+	{ }
+
+	size_t begin() const { return m_begin; }
+	size_t end() const { return m_end; }
+	size_t size() const { return m_end - m_begin; }
+	size_t grain() const { return m_grain; }
+
+	bool empty() const { return m_begin == m_end; }
+
+	bool is_divisible() const { return size() > m_grain; }
+
+	size_t middle() const { return m_begin + size() / 2; }
+
+	// Number of halvings needed to bring the range down to its grain
+	size_t depth() const {
+		size_t d = 0;
+		for (size_t n = size(); n > m_grain; n = (n + 1) / 2)
+			d++;
+		return d;
+	}
+
+private:
+	size_t m_begin;
+	size_t m_end;
+	size_t m_grain;
+};
+
+} /* staccato */
+
+#endif /* end of include guard: RANGE_HPP_Q3VMZ8XK */
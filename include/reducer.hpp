@@ -0,0 +1,64 @@
+#ifndef REDUCER_HPP_K2WQ7XEJ
+#define REDUCER_HPP_K2WQ7XEJ
+
+#include <cstddef>
+#include <functional>
+
+#include "worker_local.hpp"
+
+namespace staccato
+{
+
+// Holds one view of V per worker. A view is created from identity the
+// first time a worker asks for it, in a cache line of its own taken from
+// the worker's allocator, so updates need no atomics.
+//
+// Children are stolen rather than continuations, so a worker's view does
+// not correspond to a serial section of the program. Views are combined
+// in worker order by get(), hence op must be commutative as well as
+// associative.
+//
+// view() may only be called from tasks of the scheduler, and the reducer
+// must not outlive it.
+template <typename V, typename Op = std::plus<V>>
+class reducer
+{
+public:
+	template <typename T, size_t D, size_t H, typename P>
+	reducer(const scheduler<T, D, H, P> &sh, V identity = V(), Op op = Op());
+
+	V &view();
+
+	// Combination of all views. Call it after the scheduler's wait().
+	V get() const;
+
+private:
+	const V m_identity;
+	const Op m_op;
+
+	worker_local<V> m_views;
+};
+
+template <typename V, typename Op>
+template <typename T, size_t D, size_t H, typename P>
+reducer<V, Op>::reducer(const scheduler<T, D, H, P> &sh, V identity, Op op)
+: m_identity(identity)
+, m_op(op)
+, m_views(sh, identity)
+{ }
+
+template <typename V, typename Op>
+V &reducer<V, Op>::view()
+{
+	return m_views.local();
+}
+
+template <typename V, typename Op>
+V reducer<V, Op>::get() const
+{
+	return m_views.combine(m_identity, m_op);
+}
+
+} /* staccato */
+
+#endif /* end of include guard: REDUCER_HPP_K2WQ7XEJ */
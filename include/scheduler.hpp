@@ -2,18 +2,26 @@
 #define STACCATO_SCEDULER_H
 
 #include <cstdlib>
+#include <fstream>
+#include <ostream>
 #include <thread>
 #include <atomic>
 #include <vector>
 #include <functional>
 #include <mutex>
+#include <type_traits>
 
 #include "utils.hpp"
 #include "debug.hpp"
 
 #include "worker.hpp"
 #include "lifo_allocator.hpp"
+#include "policy.hpp"
 #include "counter.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "workspan.hpp"
+#include "perf.hpp"
 
 namespace staccato
 {
@@ -21,15 +29,50 @@ namespace staccato
 template <typename T>
 class task;
 
-template <typename T>
+// The task graph degree and height are either given to the constructor or
+// fixed at compile time. For a compile time degree the task class declares
+//     static constexpr size_t taskgraph_degree = N;
+// and the scheduler is constructed without the degree argument. Deque
+// masks, slot offsets and steal checks are then constants. A non-zero
+// Height fixes the number of preallocated levels.
+//
+// Victim selection, idle strategy, deque variant and allocator are given by
+// a policy (see policy.hpp). The task class declares it as
+//     typedef policy<...> scheduler_policy;
+// otherwise default_policy is used, which is chosen by the STACCATO_*
+// macros.
+template <
+	typename T,
+	size_t Degree = internal::static_degree<T>::value,
+	size_t Height = 0,
+	typename Policy = typename internal::policy_of<T>::type
+>
 class scheduler
 {
+	static_assert(
+		(Degree ? internal::static_next_pow2(Degree) : 0) == internal::static_degree<T>::value,
+		"Degree differs from the taskgraph_degree declared by the task");
+
+	static_assert(std::is_same<Policy, typename internal::policy_of<T>::type>::value,
+		"Policy differs from the scheduler_policy declared by the task");
+
+	typedef typename Policy::allocator allocator_t;
+
+	static const size_t default_height = Height ? Height : 1;
+
 public:
 
+	template <size_t D = Degree, typename std::enable_if<D == 0, int>::type = 0>
 	scheduler (
 		size_t taskgraph_degree,
 		size_t nworkers = 0,
-		size_t taskgraph_height = 1
+		size_t taskgraph_height = default_height
+	);
+
+	template <size_t D = Degree, typename std::enable_if<D != 0, int>::type = 0>
+	explicit scheduler (
+		size_t nworkers = 0,
+		size_t taskgraph_height = default_height
 	);
 
 	~scheduler();
@@ -38,29 +81,70 @@ public:
 	void spawn(T *t);
 	void wait();
 
+	size_t nworkers() const;
+
+	// Counters of each worker. They can be read at any time, while tasks
+	// are running too; the snapshot is then not atomic across counters.
+	// With STACCATO_STATS set in the environment, they are printed on
+	// destruction.
+	std::vector<worker_stats> stats() const;
+
+#if STACCATO_TRACE
+	// Writes the recorded events in the Chrome trace format. Workers must
+	// be idle, i.e. call it after wait(). With STACCATO_TRACE_FILE set in
+	// the environment, the trace is also written there on destruction.
+	void write_trace(std::ostream &os) const;
+#endif
+
+#if STACCATO_WORKSPAN
+	// Work and span of every root task waited for so far, in spawn order.
+	// They are also printed on destruction.
+	std::vector<workspan> workspans() const;
+#endif
+
 private:
 	struct worker_t {
 		std::thread *thr;
-		internal::lifo_allocator *alloc;
-		internal::worker<T> * wkr;
-		std::atomic_bool ready;
+		allocator_t *alloc;
+		internal::lifo_allocator *scratch;
 	};
 
     inline size_t predict_page_size() const;
 
+	static const size_t scratch_page_size = 64 * (1 << 10);
+
+	void init();
 	void create_workers();
+	void start_worker(size_t id);
 	void create_worker(size_t id);
 
+	// Waits until the worker's thread has created it
+	internal::worker<T> *get_worker(size_t id) const;
+
+	size_t taskgraph_degree() const;
+	size_t taskgraph_height() const;
+
 	const size_t m_taskgraph_degree;
 	const size_t m_taskgraph_height;
 
 	size_t m_nworkers;
 	worker_t *m_workers;
+	std::atomic<internal::worker<T> *> *m_peers;
 	internal::worker<T> *m_master;
+
+#if STACCATO_TRACE
+	internal::trace_clock m_trace_clock;
+#endif
+
+#if STACCATO_WORKSPAN
+	std::vector<T *> m_pending_roots;
+	std::vector<workspan> m_workspans;
+#endif
 };
 
-template <typename T>
-scheduler<T>::scheduler(
+template <typename T, size_t Degree, size_t Height, typename Policy>
+template <size_t D, typename std::enable_if<D == 0, int>::type>
+scheduler<T, Degree, Height, Policy>::scheduler(
 	size_t taskgraph_degree,
 	size_t nworkers,
 	size_t taskgraph_height
@@ -68,121 +152,246 @@ scheduler<T>::scheduler(
 : m_taskgraph_degree(internal::next_pow2(taskgraph_degree))
 , m_taskgraph_height(taskgraph_height)
 , m_nworkers(nworkers)
+{
+	init();
+}
+
+template <typename T, size_t Degree, size_t Height, typename Policy>
+template <size_t D, typename std::enable_if<D != 0, int>::type>
+scheduler<T, Degree, Height, Policy>::scheduler(
+	size_t nworkers,
+	size_t taskgraph_height
+)
+: m_taskgraph_degree(internal::static_next_pow2(Degree))
+, m_taskgraph_height(taskgraph_height)
+, m_nworkers(nworkers)
+{
+	init();
+}
+
+template <typename T, size_t Degree, size_t Height, typename Policy>
+void scheduler<T, Degree, Height, Policy>::init()
 {
 	internal::Debug() << "Scheduler is working in debug mode";
 
+	STACCATO_ASSERT(!Height || m_taskgraph_height == Height,
+		"Task graph height differs from the static one");
+
 	if (m_nworkers == 0)
 		m_nworkers = std::thread::hardware_concurrency();
 
 	create_workers();
 }
 
-template <typename T>
-void scheduler<T>::create_workers()
+template <typename T, size_t Degree, size_t Height, typename Policy>
+void scheduler<T, Degree, Height, Policy>::create_workers()
 {
 	using namespace internal;
 
 	m_workers = new worker_t[m_nworkers];
+	m_peers = new std::atomic<worker<T> *>[m_nworkers];
 	for (size_t i = 0; i < m_nworkers; ++i)
-		m_workers[i].ready = false;
+		store_relaxed(m_peers[i], nullptr);
 
 	create_worker(0);
 	m_workers[0].thr = nullptr;
-	m_master = m_workers[0].wkr;
+	m_master = load_relaxed(m_peers[0]);
 
-	for (size_t i = 1; i < m_nworkers; ++i) {
-		m_workers[i].thr = new std::thread([=] {
-			create_worker(i);
-			m_workers[i].wkr->steal_loop();
-		});
-	}
+	// The constructor doesn't wait for the workers: each of them finds its
+	// victims itself as the others get published
+	if (m_nworkers > 1)
+		m_workers[1].thr = new std::thread([=] { start_worker(1); });
+}
 
-	for (size_t i = 0; i < m_nworkers; ++i)
-		while (!m_workers[i].ready)
-			std::this_thread::yield();
+// Threads are started as a binary tree, worker i starting 2i and 2i + 1,
+// so there are O(log n) thread creations on the critical path. Children's
+// threads are stored before the worker is published, which makes them
+// visible to the destructor once it has seen every worker.
+template <typename T, size_t Degree, size_t Height, typename Policy>
+void scheduler<T, Degree, Height, Policy>::start_worker(size_t id)
+{
+	for (size_t c = 2 * id; c < m_nworkers && c <= 2 * id + 1; ++c)
+		m_workers[c].thr = new std::thread([=] { start_worker(c); });
 
-	for (size_t i = 0; i < m_nworkers; ++i) {
-		for (size_t j = 0; j < m_nworkers; ++j) {
-			if (i == j)
-				continue;
-			m_workers[i].wkr->cache_victim(m_workers[j].wkr);
-		}
-	}
+	create_worker(id);
+	load_relaxed(m_peers[id])->steal_loop();
 }
 
-template <typename T>
-void scheduler<T>::create_worker(size_t id)
+template <typename T, size_t Degree, size_t Height, typename Policy>
+void scheduler<T, Degree, Height, Policy>::create_worker(size_t id)
 {
 	using namespace internal;
 
 	Debug() << "Init worker #" << id;
 
-	auto alloc = new lifo_allocator(predict_page_size());
+	auto alloc = new allocator_t(predict_page_size());
+	auto scratch = new lifo_allocator(scratch_page_size);
 
-	auto wkr = alloc->alloc<worker<T>>();
-	new(wkr)
-		worker<T>(id, alloc, m_nworkers, m_taskgraph_degree, m_taskgraph_height);
+	auto wkr = alloc->template alloc<worker<T>>();
+	new(wkr) worker<T>(id, alloc, scratch,
+		m_peers, m_nworkers, taskgraph_degree(), taskgraph_height());
 
 	m_workers[id].alloc = alloc;
-	m_workers[id].wkr = wkr;
-	m_workers[id].ready = true;
+	m_workers[id].scratch = scratch;
+	store_release(m_peers[id], wkr);
 }
 
-template <typename T>
-inline size_t scheduler<T>::predict_page_size() const
+template <typename T, size_t Degree, size_t Height, typename Policy>
+internal::worker<T> *scheduler<T, Degree, Height, Policy>::get_worker(size_t id) const
+{
+	internal::worker<T> *w;
+	while (!(w = load_acquire(m_peers[id])))
+		std::this_thread::yield();
+
+	return w;
+}
+
+template <typename T, size_t Degree, size_t Height, typename Policy>
+inline size_t scheduler<T, Degree, Height, Policy>::predict_page_size() const
 {
 	using namespace internal;
 
 	size_t s = 0;
-	s += alignof(task_deque<T>) + sizeof(task_deque<T>);
-	s += alignof(T) + sizeof(T) * m_taskgraph_degree;
-	s *= m_taskgraph_height;
+	s += alignof(task_deque<T>);
+	s += task_deque<T>::footprint(taskgraph_degree());
+	s *= taskgraph_height();
 	return s;
 }
 
-template <typename T>
-scheduler<T>::~scheduler()
+template <typename T, size_t Degree, size_t Height, typename Policy>
+inline size_t scheduler<T, Degree, Height, Policy>::taskgraph_degree() const
 {
-	for (size_t i = 1; i < m_nworkers; ++i) {
-		while (!m_workers[i].ready)
-			std::this_thread::yield();
+	return Degree ? internal::static_next_pow2(Degree) : m_taskgraph_degree;
+}
 
-		m_workers[i].wkr->stop();
-	}
+template <typename T, size_t Degree, size_t Height, typename Policy>
+inline size_t scheduler<T, Degree, Height, Policy>::taskgraph_height() const
+{
+	return Height ? Height : m_taskgraph_height;
+}
+
+template <typename T, size_t Degree, size_t Height, typename Policy>
+scheduler<T, Degree, Height, Policy>::~scheduler()
+{
+	for (size_t i = 1; i < m_nworkers; ++i)
+		get_worker(i)->stop();
 
 #if STACCATO_DEBUG
 	internal::counter::print_header();
 	for (size_t i = 0; i < m_nworkers; ++i)
-		m_workers[i].wkr->print_counters();
+		get_worker(i)->print_counters();
+#endif
+
+#if STACCATO_WORKSPAN
+	for (size_t i = 0; i < m_workspans.size(); ++i)
+		internal::print_workspan(i, m_workspans[i], m_nworkers);
+#endif
+
+#if STACCATO_PERF
+	internal::print_perf_header();
+	for (size_t i = 0; i < m_nworkers; ++i) {
+		auto s = get_worker(i)->stats();
+		internal::print_perf(i, "task", s.task_perf);
+		internal::print_perf(i, "sched", s.scheduler_perf);
+	}
 #endif
 
 	for (size_t i = 1; i < m_nworkers; ++i)
 		m_workers[i].thr->join();
 
+	if (std::getenv("STACCATO_STATS")) {
+		internal::print_stats_header();
+		for (size_t i = 0; i < m_nworkers; ++i)
+			internal::print_stats(i, get_worker(i)->stats());
+	}
+
+#if STACCATO_TRACE
+	auto path = std::getenv("STACCATO_TRACE_FILE");
+	if (path) {
+		std::ofstream f(path);
+		write_trace(f);
+	}
+#endif
+
 	for (size_t i = 0; i < m_nworkers; ++i) {
+		// The worker lives in memory of its allocator
+		get_worker(i)->~worker();
 		delete m_workers[i].alloc;
+		delete m_workers[i].scratch;
 		delete m_workers[i].thr;
 	}
 
 	delete []m_workers;
+	delete []m_peers;
 }
 
-template <typename T>
-T *scheduler<T>::root()
+template <typename T, size_t Degree, size_t Height, typename Policy>
+size_t scheduler<T, Degree, Height, Policy>::nworkers() const
+{
+	return m_nworkers;
+}
+
+template <typename T, size_t Degree, size_t Height, typename Policy>
+std::vector<worker_stats> scheduler<T, Degree, Height, Policy>::stats() const
+{
+	std::vector<worker_stats> r;
+	r.reserve(m_nworkers);
+
+	for (size_t i = 0; i < m_nworkers; ++i)
+		r.push_back(get_worker(i)->stats());
+
+	return r;
+}
+
+#if STACCATO_WORKSPAN
+template <typename T, size_t Degree, size_t Height, typename Policy>
+std::vector<workspan> scheduler<T, Degree, Height, Policy>::workspans() const
+{
+	return m_workspans;
+}
+#endif
+
+#if STACCATO_TRACE
+template <typename T, size_t Degree, size_t Height, typename Policy>
+void scheduler<T, Degree, Height, Policy>::write_trace(std::ostream &os) const
+{
+	std::vector<const internal::trace_buffer *> buffers;
+	for (size_t i = 0; i < m_nworkers; ++i)
+		buffers.push_back(get_worker(i)->trace_events());
+
+	internal::write_chrome_trace(os, buffers.data(), m_nworkers, m_trace_clock);
+}
+#endif
+
+template <typename T, size_t Degree, size_t Height, typename Policy>
+T *scheduler<T, Degree, Height, Policy>::root()
 {
 	return m_master->root_allocate();
 }
 
-template <typename T>
-void scheduler<T>::spawn(T *)
+template <typename T, size_t Degree, size_t Height, typename Policy>
+void scheduler<T, Degree, Height, Policy>::spawn(T *t)
 {
+#if STACCATO_WORKSPAN
+	m_pending_roots.push_back(t);
+#else
+	(void)t;
+#endif
+
 	m_master->root_commit();
 }
 
-template <typename T>
-void scheduler<T>::wait()
+template <typename T, size_t Degree, size_t Height, typename Policy>
+void scheduler<T, Degree, Height, Policy>::wait()
 {
 	m_master->root_wait();
+
+#if STACCATO_WORKSPAN
+	// Finished roots stay in their slots until the next root is spawned
+	for (auto t : m_pending_roots)
+		m_workspans.push_back(t->work_and_span());
+	m_pending_roots.clear();
+#endif
 }
 
 } /* namespace:staccato */ 
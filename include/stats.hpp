@@ -0,0 +1,170 @@
+#ifndef STATS_HPP_H8ZC3LWE
+#define STATS_HPP_H8ZC3LWE
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+
+#include "utils.hpp"
+#include "perf.hpp"
+
+namespace staccato
+{
+
+// Snapshot of the counters of a worker
+struct worker_stats
+{
+	unsigned long spawns;
+	unsigned long takes;
+	unsigned long steals;
+	unsigned long failed_steals;
+	unsigned long grow_tails;
+	unsigned long idles;
+
+	// TSC cycles the worker was running: from the start of its thread, or
+	// during wait() for the master. Steal times include the victim scan.
+	unsigned long cycles;
+	unsigned long steal_cycles;
+	unsigned long failed_steal_cycles;
+	unsigned long idle_cycles;
+
+	// Executing tasks and taking them from own deques
+	unsigned long work_cycles() const {
+		auto other = steal_cycles + failed_steal_cycles + idle_cycles;
+		return cycles > other ? cycles - other : 0;
+	}
+
+	// Hardware events, with STACCATO_PERF only
+	perf_values task_perf;
+	perf_values scheduler_perf;
+
+	worker_stats &operator+=(const worker_stats &o) {
+		spawns += o.spawns;
+		takes += o.takes;
+		steals += o.steals;
+		failed_steals += o.failed_steals;
+		grow_tails += o.grow_tails;
+		idles += o.idles;
+		cycles += o.cycles;
+		steal_cycles += o.steal_cycles;
+		failed_steal_cycles += o.failed_steal_cycles;
+		idle_cycles += o.idle_cycles;
+		task_perf += o.task_perf;
+		scheduler_perf += o.scheduler_perf;
+		return *this;
+	}
+};
+
+namespace internal
+{
+
+// Counters of a worker that are kept in release builds. Only the owner
+// updates them, by a relaxed load and store rather than an atomic RMW, so
+// any thread can read them at any time. They take a cache line of their
+// own, away from the fields touched by thieves.
+class STACCATO_ALIGN stats_counters
+{
+public:
+	enum event_e {
+		spawn        = 0,
+		take         = 1,
+		steal        = 2,
+		failed_steal = 3,
+		grow_tail    = 4,
+		idle         = 5,
+
+		// In cycles
+		running           = 6,
+		steal_time        = 7,
+		failed_steal_time = 8,
+		idle_time         = 9
+	};
+
+	stats_counters();
+
+	void count(event_e e, unsigned long n = 1);
+
+	// The running time of the worker is counted between these
+	void start();
+	void stop();
+
+	worker_stats snapshot() const;
+
+private:
+	static const size_t m_nevents = 10;
+
+	std::atomic_ulong m_values[m_nevents];
+
+	// TSC value at start(), 0 when stopped
+	std::atomic_ulong m_started;
+};
+
+stats_counters::stats_counters()
+{
+	for (size_t i = 0; i < m_nevents; ++i)
+		store_relaxed(m_values[i], 0);
+	store_relaxed(m_started, 0);
+}
+
+inline void stats_counters::count(event_e e, unsigned long n)
+{
+	auto &v = m_values[e];
+	store_relaxed(v, load_relaxed(v) + n);
+}
+
+inline void stats_counters::start()
+{
+	store_relaxed(m_started, read_tsc());
+}
+
+inline void stats_counters::stop()
+{
+	count(running, read_tsc() - load_relaxed(m_started));
+	store_relaxed(m_started, 0);
+}
+
+worker_stats stats_counters::snapshot() const
+{
+	worker_stats s = worker_stats();
+	s.spawns = load_relaxed(m_values[spawn]);
+	s.takes = load_relaxed(m_values[take]);
+	s.steals = load_relaxed(m_values[steal]);
+	s.failed_steals = load_relaxed(m_values[failed_steal]);
+	s.grow_tails = load_relaxed(m_values[grow_tail]);
+	s.idles = load_relaxed(m_values[idle]);
+
+	s.cycles = load_relaxed(m_values[running]);
+	auto started = load_relaxed(m_started);
+	if (started)
+		s.cycles += read_tsc() - started;
+
+	s.steal_cycles = load_relaxed(m_values[steal_time]);
+	s.failed_steal_cycles = load_relaxed(m_values[failed_steal_time]);
+	s.idle_cycles = load_relaxed(m_values[idle_time]);
+	return s;
+}
+
+inline void print_stats_header()
+{
+	FILE *fp = stdout;
+
+	fprintf(fp, "[STACCATO] w# |%10s |%10s |%10s |%10s |%7s |%7s |%7s |%7s |\n",
+		"spawns", "takes", "steals", "failed", "work%", "steal%", "fail%", "idle%");
+}
+
+inline void print_stats(size_t id, const worker_stats &s)
+{
+	FILE *fp = stdout;
+
+	double c = s.cycles ? s.cycles / 100.0 : 1;
+
+	fprintf(fp, "[STACCATO]%3lu |%10lu |%10lu |%10lu |%10lu |%7.2f |%7.2f |%7.2f |%7.2f |\n",
+		id, s.spawns, s.takes, s.steals, s.failed_steals,
+		s.work_cycles() / c, s.steal_cycles / c,
+		s.failed_steal_cycles / c, s.idle_cycles / c);
+}
+
+} /* internal */
+} /* staccato */
+
+#endif /* end of include guard: STATS_HPP_H8ZC3LWE */
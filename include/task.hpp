@@ -5,8 +5,13 @@
 #include <cstdint>
 #include <functional>
 #include <cstdlib>
+#include <type_traits>
 
 #include "task_deque.hpp"
+#include "lifo_allocator.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "workspan.hpp"
 #include "utils.hpp"
 
 namespace staccato
@@ -17,26 +22,60 @@ template <typename T>
 class worker;
 }
 
+// Base of task classes. T is the derived class itself and must define
+// void execute(). It is called through static_cast<T *>(this), so tasks
+// have no vtable pointer and take less space in deque slots. Tasks are
+// never destroyed by the scheduler.
 template <typename T>
 class task {
 public:
 	task();
-	virtual ~task();
-
-	virtual void execute() = 0;
+	~task();
 
 	T *child();
 
 	void spawn(T *t);
 
+	// Memory for the i-th child of a batch. Children 0..n-1 are then
+	// published together by spawn_n(n), with a single fence.
+	T *child(size_t i);
+
+	void spawn_n(size_t n);
+
+	// Executes a child created with child() on the current thread right
+	// away. The child is never put in the deque, so it can't be stolen and
+	// wait() doesn't have to take it back. It must be the last child
+	// created before the call.
+	void call(T *t);
+
 	void wait();
+
+	// Uninitialized memory for n objects of type U. It is taken from the
+	// worker's scratch allocator and released when execute() returns, so
+	// it can be shared with children but must not outlive the task.
+	template <typename U>
+	U *scratch(size_t n = 1);
 	
 	void process(internal::worker<T> *worker, internal::task_deque<T> *tail);
 
+	// Task of type T being executed by the calling thread, if any
+	static task<T> *current();
+
+#if STACCATO_WORKSPAN
+	// Work and span of the last execution, children included
+	workspan work_and_span() const;
+#endif
+
 private:
+	static task<T> *&current_ref();
+
 	internal::worker<T> *m_worker;
 
 	internal::task_deque<T> *m_tail;
+
+#if STACCATO_WORKSPAN
+	internal::workspan_frame m_workspan;
+#endif
 };
 
 template <typename T>
@@ -53,8 +92,53 @@ void task<T>::process(internal::worker<T> *worker, internal::task_deque<T> *tail
 	m_worker = worker;
 	m_tail = tail;
 
-	execute();
+	auto alloc = worker->scratch();
+	auto m = alloc->mark();
+
+	// Tasks are nested when a thread executes other tasks inside wait()
+	auto &cur = current_ref();
+	auto parent = cur;
+	cur = this;
+
+	worker->trace_task_begin();
+	worker->perf_task_begin();
+#if STACCATO_WORKSPAN
+	m_workspan.begin();
+#endif
+
+	static_cast<T *>(this)->execute();
+
+#if STACCATO_WORKSPAN
+	m_workspan.end();
+#endif
+	worker->perf_task_end();
+	worker->trace_task_end();
+
+	cur = parent;
+
+	alloc->rewind(m);
+}
+
+template <typename T>
+task<T> *&task<T>::current_ref()
+{
+	STACCATO_TLS static task<T> *t = nullptr;
+	return t;
+}
+
+template <typename T>
+task<T> *task<T>::current()
+{
+	return current_ref();
+}
+
+#if STACCATO_WORKSPAN
+template <typename T>
+workspan task<T>::work_and_span() const
+{
+	return m_workspan.result();
 }
+#endif
 
 template <typename T>
 T *task<T>::child()
@@ -63,19 +147,131 @@ T *task<T>::child()
 }
 
 template <typename T>
-void task<T>::spawn(T *)
+void task<T>::spawn(T *t)
 {
+#if STACCATO_WORKSPAN
+	m_workspan.spawn(&t->m_workspan);
+#else
+	(void)t;
+#endif
+
 	m_tail->put_commit();
+	m_worker->count(internal::stats_counters::spawn);
+	m_worker->poll();
+}
+
+template <typename T>
+template <typename U>
+U *task<T>::scratch(size_t n)
+{
+	static_assert(std::is_trivially_destructible<U>::value,
+		"Scratch objects are never destroyed");
+
+	return m_worker->scratch()->template alloc_array<U>(n);
+}
+
+template <typename T>
+T *task<T>::child(size_t i)
+{
+	return m_tail->put_allocate(i);
+}
+
+template <typename T>
+void task<T>::spawn_n(size_t n)
+{
+#if STACCATO_WORKSPAN
+	for (size_t i = 0; i < n; ++i)
+		m_workspan.spawn(&m_tail->put_allocate(i)->m_workspan);
+#endif
+
+	m_tail->put_commit(n);
+	m_worker->count(internal::stats_counters::spawn, n);
+	m_worker->poll();
+}
+
+template <typename T>
+void task<T>::call(T *t)
+{
+#if STACCATO_WORKSPAN
+	m_workspan.pause();
+	m_worker->call(m_tail, t);
+	m_workspan.add_called(t->m_workspan);
+	m_workspan.resume();
+#else
+	m_worker->call(m_tail, t);
+#endif
 }
 
 template <typename T>
 void task<T>::wait()
 {
+	m_worker->perf_task_suspend();
+
+#if STACCATO_WORKSPAN
+	m_workspan.pause();
+	m_worker->local_loop(m_tail);
+	m_workspan.sync();
+	m_workspan.resume();
+#else
 	m_worker->local_loop(m_tail);
+#endif
+
+	m_worker->perf_task_resume();
 
 	// m_tail->reset();
 }
 
+// Forking and joining on behalf of the task being executed by the calling
+// thread, so that code called from execute() doesn't need the task object.
+// Children must be of the same type T as the running task.
+namespace this_task
+{
+
+template <typename T>
+T *child()
+{
+	STACCATO_ASSERT(task<T>::current(), "No task of this type is running");
+	return task<T>::current()->child();
+}
+
+template <typename T>
+void spawn(T *t)
+{
+	task<T>::current()->spawn(t);
+}
+
+template <typename T>
+T *child(size_t i)
+{
+	return task<T>::current()->child(i);
+}
+
+template <typename T>
+void spawn_n(size_t n)
+{
+	task<T>::current()->spawn_n(n);
+}
+
+template <typename T>
+void call(T *t)
+{
+	task<T>::current()->call(t);
+}
+
+template <typename T>
+void wait()
+{
+	task<T>::current()->wait();
+}
+
+template <typename T, typename U>
+U *scratch(size_t n = 1)
+{
+	return task<T>::current()->template scratch<U>(n);
+}
+
+} /* this_task */
+
 } /* staccato */ 
 
 
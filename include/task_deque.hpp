@@ -4,10 +4,13 @@
 #include <atomic>
 #include <cstddef>
 #include <cstring>
+#include <type_traits>
 
 #include "utils.hpp"
 #include "debug.hpp"
 #include "lifo_allocator.hpp"
+#include "asymmetric_fence.hpp"
+#include "policy.hpp"
 
 namespace staccato
 {
@@ -15,13 +18,29 @@ namespace staccato
 namespace internal
 {
 
+// Task graph degree declared by T as a static constexpr taskgraph_degree
+// member, rounded up to a power of 2. Zero if T doesn't declare it, then
+// the degree is given to the scheduler at runtime.
+template <typename T, typename = void>
+struct static_degree: std::integral_constant<size_t, 0>
+{ };
+
+template <typename T>
+struct static_degree<T, decltype(void(T::taskgraph_degree))>
+: std::integral_constant<size_t, static_next_pow2(T::taskgraph_degree)>
+{ };
+
 template <typename T>
 class task_deque
 {
 public:
-	task_deque(size_t size, T *mem);
+	// The deque is followed by its slots, so it must be placed in memory
+	// of footprint(size) bytes
+	task_deque(size_t size);
 	~task_deque();
 
+	static constexpr size_t footprint(size_t size);
+
 	void set_prev(task_deque<T> *d);
 	void set_next(task_deque<T> *d);
 	void set_victim(task_deque<T> *d);
@@ -30,41 +49,115 @@ public:
 
 	void return_stolen();
 
-	T *put_allocate();
-	void put_commit();
+	T *put_allocate(size_t offset = 0);
+	void put_commit(size_t n = 1);
 
 	T *take(size_t *);
 	T *steal(bool *was_empty);
 
+	// Removes the oldest task on behalf of a thief. Only the owner may
+	// call it, and only with private deques.
+	T *transfer();
+
+	// One of STACCATO_DEQUE_* chosen by the policy of T
+	static constexpr int variant();
+
+#if STACCATO_DEBUG
+	size_t npublished() const;
+#endif
+
 private:
-	const size_t m_mask;
+	static constexpr size_t slots_offset();
+
+	T *slot(size_t i);
 
-	// TODO: make this array a part of this class
-	T * m_array;
+	size_t mask() const;
+
+	T *take_shared(size_t *nstolen);
+	T *take_private(size_t *nstolen);
+	T *take_split(size_t *nstolen);
+
+	T *steal_shared(bool *was_empty);
+	T *steal_split(bool *was_empty);
+
+	void publish();
+
+	const size_t m_mask;
 
 	task_deque<T> *m_next;
 
 	STACCATO_ALIGN std::atomic_size_t m_nstolen;
 	STACCATO_ALIGN std::atomic_size_t m_top;
 	STACCATO_ALIGN std::atomic_size_t m_bottom;
+
+	// Split deques only. Tasks in [top, split) can be stolen, tasks in
+	// [split, bottom) are private. Bottom is accessed only by the owner.
+	STACCATO_ALIGN std::atomic_size_t m_split;
+
+	// Set by thieves that found the public part empty
+	STACCATO_ALIGN std::atomic_bool m_demand;
+
+#if STACCATO_DEBUG
+	size_t m_npublished;
+#endif
 };
 
 template <typename T>
-task_deque<T>::task_deque(size_t size, T *mem)
+task_deque<T>::task_deque(size_t size)
 : m_mask(size - 1)
-, m_array(mem)
 , m_next(nullptr)
 , m_nstolen(0)
 , m_top(1)
 , m_bottom(1)
+, m_split(1)
+, m_demand(false)
+#if STACCATO_DEBUG
+, m_npublished(0)
+#endif
 {
+	static_assert(alignof(T) <= alignof(task_deque<T>),
+		"Tasks are aligned stricter than deques");
+
 	STACCATO_ASSERT(is_pow2(size), "Deque size is not power of 2");
+	STACCATO_ASSERT(!static_degree<T>::value || size == static_degree<T>::value,
+		"Deque size differs from the static degree");
+}
+
+template <typename T>
+constexpr size_t task_deque<T>::slots_offset()
+{
+	return (sizeof(task_deque<T>) + alignof(T) - 1) & ~(alignof(T) - 1);
+}
+
+template <typename T>
+constexpr size_t task_deque<T>::footprint(size_t size)
+{
+	return slots_offset() + sizeof(T) * size;
+}
+
+template <typename T>
+inline T *task_deque<T>::slot(size_t i)
+{
+	auto p = reinterpret_cast<uint8_t *>(this) + slots_offset();
+	return reinterpret_cast<T *>(p) + (i & mask());
+}
+
+template <typename T>
+inline size_t task_deque<T>::mask() const
+{
+	return static_degree<T>::value ? static_degree<T>::value - 1 : m_mask;
 }
 
 template <typename T>
 task_deque<T>::~task_deque()
 { }
 
+template <typename T>
+constexpr int task_deque<T>::variant()
+{
+	return policy_of<T>::type::deque::variant;
+}
+
 template <typename T>
 void task_deque<T>::set_next(task_deque<T> *d)
 {
@@ -77,25 +170,174 @@ task_deque<T> *task_deque<T>::get_next()
 	return m_next;
 }
 
+// Several tasks can be put at once: they are allocated at increasing
+// offsets from the bottom and then committed with a single fence.
 template <typename T>
-T *task_deque<T>::put_allocate()
+T *task_deque<T>::put_allocate(size_t offset)
 {
 	auto b = load_relaxed(m_bottom);
-	return &m_array[b & m_mask];
+	return slot(b + offset);
 }
 
 template <typename T>
-void task_deque<T>::put_commit()
+void task_deque<T>::put_commit(size_t n)
 {
 	auto b = load_relaxed(m_bottom);
-	atomic_fence_release();
-	store_relaxed(m_bottom, b + 1);
+	if (variant() == STACCATO_DEQUE_SHARED)
+		atomic_fence_release();
+	store_relaxed(m_bottom, b + n);
+
+	if (variant() == STACCATO_DEQUE_SPLIT && load_relaxed(m_demand))
+		publish();
 }
 
 template <typename T>
 T *task_deque<T>::take(size_t *nstolen)
 {
+	if (variant() == STACCATO_DEQUE_PRIVATE)
+		return take_private(nstolen);
+	if (variant() == STACCATO_DEQUE_SPLIT)
+		return take_split(nstolen);
+	return take_shared(nstolen);
+}
+
+template <typename T>
+T *task_deque<T>::steal(bool *was_empty)
+{
+	if (variant() == STACCATO_DEQUE_SPLIT)
+		return steal_split(was_empty);
+	return steal_shared(was_empty);
+}
+
+// Nobody but the owner touches top and bottom, so no synchronization is
+// needed apart from the counter of stolen tasks.
+template <typename T>
+T *task_deque<T>::take_private(size_t *nstolen)
+{
+	auto b = load_relaxed(m_bottom);
+	auto t = load_relaxed(m_top);
+
+	if (t == b) {
+		*nstolen = load_acquire(m_nstolen);
+		return nullptr;
+	}
+
+	store_relaxed(m_bottom, b - 1);
+	return slot(b - 1);
+}
+
+template <typename T>
+T *task_deque<T>::transfer()
+{
+	auto t = load_relaxed(m_top);
+
+	if (t == load_relaxed(m_bottom))
+		return nullptr;
+
+	inc_relaxed(m_nstolen);
+	store_relaxed(m_top, t + 1);
+
+	return slot(t);
+}
+
+// Makes all private tasks visible to thieves
+template <typename T>
+void task_deque<T>::publish()
+{
+	// A thief that sets demand again after this is served by the next put
+	store_relaxed(m_demand, false);
+	atomic_fence_release();
+	store_relaxed(m_split, load_relaxed(m_bottom));
+
+#if STACCATO_DEBUG
+	m_npublished++;
+#endif
+}
+
+template <typename T>
+T *task_deque<T>::take_split(size_t *nstolen)
+{
+	auto b = load_relaxed(m_bottom);
+	auto s = load_relaxed(m_split);
+
+	// The newest task is private, no synchronization is needed
+	if (b > s) {
+		store_relaxed(m_bottom, b - 1);
+
+		if (b - 1 > s && load_relaxed(m_demand))
+			publish();
+
+		return slot(b - 1);
+	}
+
+	// Otherwise the public part is taken from as in shared deques, with
+	// split in place of bottom. Both are kept equal after that.
+	s = dec_relaxed(m_split) - 1;
+	auto t = load_relaxed(m_top);
+	auto n = load_relaxed(m_nstolen);
+
+	if (t > s) {
+		store_relaxed(m_split, s + 1);
+		*nstolen = n;
+		return nullptr;
+	}
+
+	if (t == s) {
+		if (!cas_strong(m_top, t, t + 1)) {
+			m_split = s + 1;
+			*nstolen = n + 1;
+			return nullptr;
+		}
+
+		m_split = s + 1;
+		return slot(s);
+	}
+
+	store_relaxed(m_bottom, s);
+	return slot(s);
+}
+
+template <typename T>
+T *task_deque<T>::steal_split(bool *was_empty)
+{
+	auto t = load_acquire(m_top);
+	atomic_fence_seq_cst();
+	auto s = load_acquire(m_split);
+
+	if (t >= s) {
+		// Bottom is read only as a hint whether there is anything to ask for
+		if (load_relaxed(m_bottom) > s && !load_relaxed(m_demand))
+			store_relaxed(m_demand, true);
+
+		*was_empty = true;
+		return nullptr;
+	}
+
+	auto r = slot(t);
+
+	inc_relaxed(m_nstolen);
+
+	if (!cas_weak(m_top, t, t + 1)) {
+		dec_relaxed(m_nstolen);
+		return nullptr;
+	}
+
+	return r;
+}
+
+template <typename T>
+T *task_deque<T>::take_shared(size_t *nstolen)
+{
+#if STACCATO_ASYMMETRIC_FENCE
+	// Only the owner writes bottom, so no RMW is needed. The store has to
+	// be ordered before the load of top, which is done by the light fence
+	// here paired with the heavy one in steal().
+	auto b = load_relaxed(m_bottom) - 1;
+	store_relaxed(m_bottom, b);
+	asymmetric_fence::light();
+#else
 	auto b = dec_relaxed(m_bottom) - 1;
+#endif
 	auto t = load_relaxed(m_top);
 	auto n = load_relaxed(m_nstolen);
 
@@ -119,18 +361,30 @@ T *task_deque<T>::take(size_t *nstolen)
 
 		// Wasn't stolen, but we icnremented top index
 		m_bottom = b + 1;
-		return &m_array[b & m_mask];
+		return slot(b);
 	}
 
 	// The task can't be stolen, no need for CAS
-	return &m_array[b & m_mask];
+	return slot(b);
 }
  
 template <typename T>
-T *task_deque<T>::steal(bool *was_empty)
+T *task_deque<T>::steal_shared(bool *was_empty)
 {
 	auto t = load_acquire(m_top);
+
+#if STACCATO_ASYMMETRIC_FENCE
+	// Heavy fences are only paid when there seems to be something to steal
+	if (t >= load_relaxed(m_bottom)) {
+		*was_empty = true;
+		return nullptr;
+	}
+
+	asymmetric_fence::heavy();
+#else
 	atomic_fence_seq_cst();
+#endif
+
 	auto b = load_acquire(m_bottom);
 
 	// Check if deque was empty
@@ -139,7 +393,7 @@ T *task_deque<T>::steal(bool *was_empty)
 		return nullptr;
 	} 
 
-	auto r = &m_array[t & m_mask];
+	auto r = slot(t);
 
 	inc_relaxed(m_nstolen);
 
@@ -159,6 +413,14 @@ void task_deque<T>::return_stolen()
 	dec_relaxed(m_nstolen);
 }
 
+#if STACCATO_DEBUG
+template <typename T>
+size_t task_deque<T>::npublished() const
+{
+	return m_npublished;
+}
+#endif
+
 } // namespace internal
 } // namespace stacccato
 
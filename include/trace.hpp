@@ -0,0 +1,193 @@
+#ifndef TRACE_HPP_9PLV2TNS
+#define TRACE_HPP_9PLV2TNS
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+#include "utils.hpp"
+
+namespace staccato
+{
+namespace internal
+{
+
+// Maps TSC values to microseconds since the clock was created. The TSC
+// rate is taken from the steady clock over the same interval when the
+// trace is written, so no calibration delay is needed at startup.
+class trace_clock
+{
+public:
+	trace_clock();
+
+	void calibrate();
+
+	double to_us(uint64_t tsc) const;
+
+private:
+	uint64_t m_tsc0;
+	std::chrono::steady_clock::time_point m_time0;
+	double m_us_per_tick;
+};
+
+trace_clock::trace_clock()
+: m_tsc0(read_tsc())
+, m_time0(std::chrono::steady_clock::now())
+, m_us_per_tick(0)
+{ }
+
+void trace_clock::calibrate()
+{
+	auto ticks = read_tsc() - m_tsc0;
+	auto us = std::chrono::duration<double, std::micro>(
+		std::chrono::steady_clock::now() - m_time0).count();
+
+	m_us_per_tick = ticks ? us / ticks : 0;
+}
+
+double trace_clock::to_us(uint64_t tsc) const
+{
+	return (tsc - m_tsc0) * m_us_per_tick;
+}
+
+struct trace_event
+{
+	enum type_e {
+		task_begin   = 0,
+		task_end     = 1,
+		wait_begin   = 2,
+		wait_end     = 3,
+		steal        = 4,
+		failed_steal = 5,
+		idle         = 6
+	};
+
+	uint64_t tsc;
+	uint64_t type;
+};
+
+// Ring buffer of the last events of a worker. Only the owner records
+// events; the memory is given once, so recording never allocates. The
+// oldest events are overwritten when the buffer is full.
+class trace_buffer
+{
+public:
+	trace_buffer();
+
+	// size must be a power of 2
+	void init(trace_event *events, size_t size);
+
+	void record(trace_event::type_e type);
+
+	// Events in recording order. Must not be called while the owner is
+	// recording.
+	template <typename F>
+	void for_each(F f) const;
+
+private:
+	trace_event *m_events;
+	size_t m_mask;
+	std::atomic_size_t m_count;
+};
+
+trace_buffer::trace_buffer()
+: m_events(nullptr)
+, m_mask(0)
+, m_count(0)
+{ }
+
+void trace_buffer::init(trace_event *events, size_t size)
+{
+	STACCATO_ASSERT(is_pow2(size), "Trace buffer size is not a power of 2");
+
+	m_events = events;
+	m_mask = size - 1;
+}
+
+inline void trace_buffer::record(trace_event::type_e type)
+{
+	auto n = load_relaxed(m_count);
+
+	auto &e = m_events[n & m_mask];
+	e.tsc = read_tsc();
+	e.type = type;
+
+	store_relaxed(m_count, n + 1);
+}
+
+template <typename F>
+void trace_buffer::for_each(F f) const
+{
+	auto n = load_relaxed(m_count);
+	auto first = n > m_mask + 1 ? n - m_mask - 1 : 0;
+
+	for (auto i = first; i < n; ++i)
+		f(m_events[i & m_mask]);
+}
+
+// Writes events of all workers in the Chrome trace event format, which is
+// also read by Perfetto. Tasks and waits become nested slices, steals and
+// idle rounds become instant events. Each worker is a thread of its own.
+inline void write_chrome_trace(
+	std::ostream &os,
+	const trace_buffer *const *buffers,
+	size_t nworkers,
+	trace_clock clock
+) {
+	static const char *names[] = {
+		"task", "task", "wait", "wait", "steal", "failed steal", "idle"
+	};
+
+	static const char *phases[] = {
+		"B", "E", "B", "E", "i", "i", "i"
+	};
+
+	clock.calibrate();
+
+	auto flags = os.flags();
+	auto precision = os.precision();
+	os.setf(std::ios::fixed, std::ios::floatfield);
+	os.precision(3);
+
+	os << "{\"traceEvents\":[\n";
+
+	bool first = true;
+	for (size_t id = 0; id < nworkers; ++id) {
+		os << (first ? "" : ",\n");
+		os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << id
+			<< ",\"args\":{\"name\":\"worker " << id << "\"}}";
+		first = false;
+
+		// Slices whose begin was overwritten in the ring are dropped
+		size_t depth = 0;
+
+		buffers[id]->for_each([&](const trace_event &e) {
+			if (phases[e.type][0] == 'B') {
+				depth++;
+			} else if (phases[e.type][0] == 'E') {
+				if (depth == 0)
+					return;
+				depth--;
+			}
+
+			os << ",\n{\"name\":\"" << names[e.type]
+				<< "\",\"ph\":\"" << phases[e.type] << "\"";
+			if (phases[e.type][0] == 'i')
+				os << ",\"s\":\"t\"";
+			os << ",\"ts\":" << clock.to_us(e.tsc)
+				<< ",\"pid\":0,\"tid\":" << id << "}";
+		});
+	}
+
+	os << "\n]}\n";
+
+	os.flags(flags);
+	os.precision(precision);
+}
+
+} /* internal */
+} /* staccato */
+
+#endif /* end of include guard: TRACE_HPP_9PLV2TNS */
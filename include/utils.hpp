@@ -2,18 +2,113 @@
 #define UTILS_HPP_CSPTFG9B
 
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 
 #ifndef STACCATO_DEBUG
 #	define STACCATO_DEBUG 0
 #endif // STACCATO_DEBUG
 
+// Use membarrier() based asymmetric fences in task deques (Linux only)
+#ifndef STACCATO_ASYMMETRIC_FENCE
+#	define STACCATO_ASYMMETRIC_FENCE 0
+#endif // STACCATO_ASYMMETRIC_FENCE
+
+// Task deques implementation:
+// shared  - thieves take tasks from deques directly, synchronizing by CAS
+// private - deques are accessed only by the owner, which hands tasks over
+//           to thieves on request
+// split   - the newest tasks are kept in a private part of the deque and
+//           published to thieves only when they ask for work
+#define STACCATO_DEQUE_SHARED 0
+#define STACCATO_DEQUE_PRIVATE 1
+#define STACCATO_DEQUE_SPLIT 2
+
+#ifndef STACCATO_DEQUE
+#	define STACCATO_DEQUE STACCATO_DEQUE_SHARED
+#endif // STACCATO_DEQUE
+
+// Victim selection: random or round robin
+#define STACCATO_VICTIM_RANDOM 0
+#define STACCATO_VICTIM_ROUND_ROBIN 1
+
+#ifndef STACCATO_VICTIM
+#	define STACCATO_VICTIM STACCATO_VICTIM_RANDOM
+#endif // STACCATO_VICTIM
+
+// What a worker does after a failed steal: yield the CPU, spin, or spin
+// with exponential backoff before yielding
+#define STACCATO_IDLE_YIELD 0
+#define STACCATO_IDLE_SPIN 1
+#define STACCATO_IDLE_BACKOFF 2
+
+#ifndef STACCATO_IDLE
+#	define STACCATO_IDLE STACCATO_IDLE_YIELD
+#endif // STACCATO_IDLE
+
+// Allocator of deques and other per-worker memory
+#define STACCATO_ALLOCATOR_LIFO 0
+#define STACCATO_ALLOCATOR_HEAP 1
+
+#ifndef STACCATO_ALLOCATOR
+#	define STACCATO_ALLOCATOR STACCATO_ALLOCATOR_LIFO
+#endif // STACCATO_ALLOCATOR
+
+// The macros above only choose the default scheduler policy, see policy.hpp
+
+// Record per-worker traces of task execution and steals (see trace.hpp)
+#ifndef STACCATO_TRACE
+#	define STACCATO_TRACE 0
+#endif // STACCATO_TRACE
+
+// Number of trace events kept per worker, a power of 2
+#ifndef STACCATO_TRACE_SIZE
+#	define STACCATO_TRACE_SIZE (1 << 16)
+#endif // STACCATO_TRACE_SIZE
+
+// Only tasks nested less than this deep on a worker are traced. Deeper
+// tasks cost a counter update instead of two timestamps. Set it to
+// SIZE_MAX to trace every task.
+#ifndef STACCATO_TRACE_DEPTH
+#	define STACCATO_TRACE_DEPTH 16
+#endif // STACCATO_TRACE_DEPTH
+
+// Measure work and span of root tasks (see workspan.hpp)
+#ifndef STACCATO_WORKSPAN
+#	define STACCATO_WORKSPAN 0
+#endif // STACCATO_WORKSPAN
+
+// Cycles charged to the burdened span for every spawned child on the
+// critical path, i.e. the cost of stealing it. Cilkview uses the same.
+#ifndef STACCATO_WORKSPAN_BURDEN
+#	define STACCATO_WORKSPAN_BURDEN 15000
+#endif // STACCATO_WORKSPAN_BURDEN
+
+// Count hardware events of every worker with perf_event_open(), split
+// between task code and scheduler code (Linux only, see perf.hpp)
+#ifndef STACCATO_PERF
+#	define STACCATO_PERF 0
+#endif // STACCATO_PERF
+
+// Counters are read around tasks nested less than this deep on a worker.
+// Deeper tasks and the scheduler code they run count as task code of
+// their ancestor.
+#ifndef STACCATO_PERF_DEPTH
+#	define STACCATO_PERF_DEPTH 16
+#endif // STACCATO_PERF_DEPTH
+
 #if !defined(LEVEL1_DCACHE_LINESIZE) || LEVEL1_DCACHE_LINESIZE == 0
 #	define STACCATO_CACHE_SIZE 64
 #else
 #	define STACCATO_CACHE_SIZE LEVEL1_DCACHE_LINESIZE
 #endif // LEVEL1_DCACHE_LINESIZE
 
+#if !defined(LEVEL2_CACHE_SIZE) || LEVEL2_CACHE_SIZE == 0
+#	define STACCATO_L2_CACHE_SIZE (256 * 1024)
+#else
+#	define STACCATO_L2_CACHE_SIZE LEVEL2_CACHE_SIZE
+#endif // LEVEL2_CACHE_SIZE
+
 // XXX: not tested
 #if __cplusplus > 199711L
 #	define STACCATO_TLS thread_local
@@ -99,6 +194,22 @@ inline uint32_t xorshift_rand() {
 	return x;
 }
 
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+// Cycles of the time stamp counter, or nanoseconds where there is none
+inline uint64_t read_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
 inline bool is_pow2(uint64_t x) {
 	return x && !(x & (x - 1));
 }
@@ -115,6 +226,11 @@ inline uint64_t next_pow2(uint64_t x)
 	return x + 1;
 }
 
+constexpr uint64_t static_next_pow2(uint64_t x, uint64_t p = 1)
+{
+	return p >= x ? p : static_next_pow2(x, p << 1);
+}
+
 } /* internal */ 
 } /* staccato */ 
 
@@ -9,36 +9,94 @@
 
 #include "task_deque.hpp"
 #include "lifo_allocator.hpp"
+#include "policy.hpp"
 #include "task.hpp"
 #include "counter.hpp"
+#include "stats.hpp"
+#include "trace.hpp"
+#include "perf.hpp"
 
 namespace staccato
 {
 namespace internal
 {
 
+// Identity of the worker that runs on the current thread. Its allocator
+// type depends on the policy, so it is reached through a function.
+struct worker_context
+{
+	size_t id;
+	void *allocator;
+	void *(*allocate)(void *allocator, size_t alignment, size_t size);
+
+	template <typename U>
+	U *alloc() {
+		return reinterpret_cast<U *>(allocate(allocator, alignof(U), sizeof(U)));
+	}
+};
+
+inline worker_context *&this_worker()
+{
+	STACCATO_TLS static worker_context *ctx = nullptr;
+	return ctx;
+}
+
 template <typename T>
 class worker
 {
+	typedef typename policy_of<T>::type policy_t;
+	typedef typename policy_t::allocator allocator_t;
+
 public:
 	worker(
 		size_t id,
-		lifo_allocator *alloc,
-		size_t nvictims,
+		allocator_t *alloc,
+		lifo_allocator *scratch,
+		std::atomic<worker<T> *> *peers,
+		size_t npeers,
 		size_t taskgraph_degree,
 		size_t taskgraph_height
 	);
 
 	~worker();
 
-	void cache_victim(worker<T> *victim);
-
 	void stop();
 
 	void local_loop(task_deque<T> *tail);
 
 	void steal_loop();
 
+	void call(task_deque<T> *tail, task<T> *t);
+
+	// Answers a pending steal request (private deques only)
+	void poll();
+
+	void count(stats_counters::event_e e, unsigned long n = 1);
+
+	worker_stats stats() const;
+
+	// Records a trace event if tracing is enabled
+	void trace(trace_event::type_e e);
+
+	// Task slices are recorded only for tasks nested less than
+	// STACCATO_TRACE_DEPTH deep
+	void trace_task_begin();
+	void trace_task_end();
+
+#if STACCATO_TRACE
+	const trace_buffer *trace_events() const;
+#endif
+
+	// Switch performance counters between task and scheduler code if they
+	// are enabled, for tasks nested less than STACCATO_PERF_DEPTH deep. A
+	// task is suspended while it waits for or calls its children.
+	void perf_task_begin();
+	void perf_task_end();
+	void perf_task_suspend();
+	void perf_task_resume();
+
+	lifo_allocator *scratch() const;
+
 	T *root_allocate();
 	void root_commit();
 	void root_wait();
@@ -50,59 +108,149 @@ public:
 private:
 	void init(size_t core_id, worker<T> *victim);
 
+	task_deque<T> *alloc_deque();
+
+	size_t taskgraph_degree() const;
+
+	static constexpr int deque_variant();
+
+	static void *allocate(void *allocator, size_t alignment, size_t size);
+
 	void grow_tail(task_deque<T> *tail);
 
+	void cache_victim(worker<T> *victim);
+
+	void find_victims();
+
 	task_deque<T> *get_victim();
 
 	task<T> *steal_task(task_deque<T> *tail, task_deque<T> **victim);
 
+	void count_steal_time(bool stolen, uint64_t since);
+
+	void idle_round();
+
+	// Private deques only
+	enum transfer_e {
+		transfer_wait = 0,
+		transfer_done = 1,
+		transfer_none = 2
+	};
+
+	void respond(worker<T> *thief);
+
+	task<T> *request_task(task_deque<T> **victim);
+
 	const size_t m_id;
+	worker_context m_context;
 	const size_t m_taskgraph_degree;
 	const size_t m_taskgraph_height;
-	lifo_allocator *m_allocator;
+	allocator_t *m_allocator;
+	lifo_allocator *m_scratch;
+
+	typename policy_t::victim m_victim;
+	typename policy_t::idle m_idle;
 
 #if STACCATO_DEBUG
 	counter m_counter;
 #endif
 
+	stats_counters m_stats;
+
+#if STACCATO_TRACE
+	trace_buffer m_trace;
+	size_t m_trace_depth;
+#endif
+
+#if STACCATO_PERF
+	perf_counters m_perf;
+	size_t m_perf_depth;
+#endif
+
 	std::atomic_bool m_stopped;
 
-	std::atomic_size_t m_nvictims;
+	// Workers of the scheduler, published by their threads as they start.
+	// Victims are taken from there in id order up to the first one that
+	// isn't published yet.
+	std::atomic<worker<T> *> *m_peers;
+	const size_t m_npeers;
+	size_t m_next_peer;
+
+	size_t m_nvictims;
 
 	task_deque<T> **m_victims_heads;
 
 	task_deque<T> *m_head_deque;
+
+	// Private deques only
+	worker<T> **m_victims;
+
+	// Thief waiting for a task from this worker
+	STACCATO_ALIGN std::atomic<worker<T> *> m_request;
+
+	// Answer to the request made by this worker
+	STACCATO_ALIGN std::atomic_int m_transfer;
+	task<T> *m_transfer_task;
+	task_deque<T> *m_transfer_deque;
 };
 
 template <typename T>
 worker<T>::worker(
 	size_t id,
-	lifo_allocator *alloc,
-	size_t nvictims,
+	allocator_t *alloc,
+	lifo_allocator *scratch,
+	std::atomic<worker<T> *> *peers,
+	size_t npeers,
 	size_t taskgraph_degree,
 	size_t taskgraph_height
 )
 : m_id(id)
+, m_context({id, alloc, allocate})
 , m_taskgraph_degree(taskgraph_degree)
 , m_taskgraph_height(taskgraph_height)
 , m_allocator(alloc)
+, m_scratch(scratch)
+, m_victim(id)
+#if STACCATO_TRACE
+, m_trace_depth(0)
+#endif
+#if STACCATO_PERF
+, m_perf_depth(0)
+#endif
 , m_stopped(false)
+, m_peers(peers)
+, m_npeers(npeers)
+, m_next_peer(0)
 , m_nvictims(0)
 , m_victims_heads(nullptr)
 , m_head_deque(nullptr)
+, m_victims(nullptr)
+, m_request(nullptr)
+, m_transfer(transfer_none)
+, m_transfer_task(nullptr)
+, m_transfer_deque(nullptr)
 {
-	m_victims_heads = m_allocator->alloc_array<task_deque<T> *>(nvictims);
+	m_victims_heads = m_allocator->template alloc_array<task_deque<T> *>(npeers);
+	if (deque_variant() == STACCATO_DEQUE_PRIVATE)
+		m_victims = m_allocator->template alloc_array<worker<T> *>(npeers);
+
+#if STACCATO_TRACE
+	m_trace.init(
+		m_allocator->template alloc_array<trace_event>(STACCATO_TRACE_SIZE),
+		STACCATO_TRACE_SIZE);
+#endif
 
-	auto d = m_allocator->alloc<task_deque<T>>();
-	auto t = m_allocator->alloc_array<T>(m_taskgraph_degree);
-	new(d) task_deque<T>(m_taskgraph_degree, t);
+#if STACCATO_PERF
+	// Workers are created by their own threads
+	m_perf.open();
+#endif
+
+	auto d = alloc_deque();
 
 	m_head_deque = d;
 
 	for (size_t i = 1; i < m_taskgraph_height + 1; ++i) {
-		auto n = m_allocator->alloc<task_deque<T>>();
-		auto t = m_allocator->alloc_array<T>(m_taskgraph_degree);
-		new(n) task_deque<T>(m_taskgraph_degree, t);
+		auto n = alloc_deque();
 
 		d->set_next(n);
 		d = n;
@@ -111,23 +259,158 @@ worker<T>::worker(
 
 template <typename T>
 worker<T>::~worker()
-{
-	delete m_allocator;
-}
+{ }
 
 template <typename T>
 void worker<T>::cache_victim(worker<T> *victim)
 {
 	m_victims_heads[m_nvictims] = victim->m_head_deque;
+	if (deque_variant() == STACCATO_DEQUE_PRIVATE)
+		m_victims[m_nvictims] = victim;
 	m_nvictims++;
 }
 
+template <typename T>
+void worker<T>::find_victims()
+{
+	for (; m_next_peer < m_npeers; ++m_next_peer) {
+		if (m_next_peer == m_id)
+			continue;
+
+		auto v = load_acquire(m_peers[m_next_peer]);
+		if (!v)
+			return;
+
+		cache_victim(v);
+	}
+}
+
 template <typename T>
 void worker<T>::stop()
 {
 	m_stopped = true;
 }
 
+template <typename T>
+void worker<T>::call(task_deque<T> *tail, task<T> *t)
+{
+	perf_task_suspend();
+
+	grow_tail(tail);
+	t->process(this, tail->get_next());
+
+	perf_task_resume();
+}
+
+template <typename T>
+inline void worker<T>::poll()
+{
+	if (deque_variant() != STACCATO_DEQUE_PRIVATE)
+		return;
+
+	auto thief = load_relaxed(m_request);
+	if (thief)
+		respond(thief);
+}
+
+template <typename T>
+inline void worker<T>::count(stats_counters::event_e e, unsigned long n)
+{
+	m_stats.count(e, n);
+}
+
+template <typename T>
+worker_stats worker<T>::stats() const
+{
+	auto s = m_stats.snapshot();
+
+#if STACCATO_PERF
+	s.task_perf = m_perf.snapshot(perf_counters::in_task);
+	s.scheduler_perf = m_perf.snapshot(perf_counters::in_scheduler);
+#endif
+
+	return s;
+}
+
+template <typename T>
+inline void worker<T>::trace(trace_event::type_e e)
+{
+#if STACCATO_TRACE
+	m_trace.record(e);
+#else
+	(void)e;
+#endif
+}
+
+template <typename T>
+inline void worker<T>::trace_task_begin()
+{
+#if STACCATO_TRACE
+	if (m_trace_depth++ < STACCATO_TRACE_DEPTH)
+		m_trace.record(trace_event::task_begin);
+#endif
+}
+
+template <typename T>
+inline void worker<T>::trace_task_end()
+{
+#if STACCATO_TRACE
+	if (--m_trace_depth < STACCATO_TRACE_DEPTH)
+		m_trace.record(trace_event::task_end);
+#endif
+}
+
+#if STACCATO_TRACE
+template <typename T>
+const trace_buffer *worker<T>::trace_events() const
+{
+	return &m_trace;
+}
+#endif
+
+template <typename T>
+inline void worker<T>::perf_task_begin()
+{
+#if STACCATO_PERF
+	if (m_perf_depth++ < STACCATO_PERF_DEPTH)
+		m_perf.enter(perf_counters::in_task);
+#endif
+}
+
+template <typename T>
+inline void worker<T>::perf_task_end()
+{
+#if STACCATO_PERF
+	if (--m_perf_depth < STACCATO_PERF_DEPTH)
+		m_perf.enter(perf_counters::in_scheduler);
+#endif
+}
+
+// Children of the task are measured only if they are shallow enough
+template <typename T>
+inline void worker<T>::perf_task_suspend()
+{
+#if STACCATO_PERF
+	if (m_perf_depth < STACCATO_PERF_DEPTH)
+		m_perf.enter(perf_counters::in_scheduler);
+#endif
+}
+
+template <typename T>
+inline void worker<T>::perf_task_resume()
+{
+#if STACCATO_PERF
+	if (m_perf_depth < STACCATO_PERF_DEPTH)
+		m_perf.enter(perf_counters::in_task);
+#endif
+}
+
+template <typename T>
+lifo_allocator *worker<T>::scratch() const
+{
+	return m_scratch;
+}
+
 template <typename T>
 T *worker<T>::root_allocate()
 {
@@ -138,12 +421,56 @@ template <typename T>
 void worker<T>::root_commit()
 {
 	m_head_deque->put_commit();
+	m_stats.count(stats_counters::spawn);
 }
 
 template <typename T>
 void worker<T>::root_wait()
 {
+	// The master thread may be shared by several schedulers
+	auto prev = this_worker();
+	this_worker() = &m_context;
+
+#if STACCATO_PERF
+	m_perf.enter(perf_counters::in_scheduler);
+#endif
+	m_stats.start();
+
 	local_loop(m_head_deque);
+
+	m_stats.stop();
+#if STACCATO_PERF
+	m_perf.enter(perf_counters::outside);
+#endif
+
+	this_worker() = prev;
+}
+
+template <typename T>
+inline size_t worker<T>::taskgraph_degree() const
+{
+	return static_degree<T>::value ? static_degree<T>::value : m_taskgraph_degree;
+}
+
+template <typename T>
+constexpr int worker<T>::deque_variant()
+{
+	return task_deque<T>::variant();
+}
+
+template <typename T>
+void *worker<T>::allocate(void *allocator, size_t alignment, size_t size)
+{
+	return reinterpret_cast<allocator_t *>(allocator)->alloc(alignment, size);
+}
+
+template <typename T>
+task_deque<T> *worker<T>::alloc_deque()
+{
+	auto size = task_deque<T>::footprint(taskgraph_degree());
+	auto d = m_allocator->template alloc_extended<task_deque<T>>(size);
+	new(d) task_deque<T>(taskgraph_degree());
+	return d;
 }
 
 template <typename T>
@@ -152,11 +479,10 @@ void worker<T>::grow_tail(task_deque<T> *tail)
 	if (tail->get_next())
 		return;
 
-	auto d = m_allocator->alloc<task_deque<T>>();
-	auto t = m_allocator->alloc_array<T>(m_taskgraph_degree);
-	new(d) task_deque<T>(m_taskgraph_degree, t);
+	auto d = alloc_deque();
 
 	tail->set_next(d);
+	m_stats.count(stats_counters::grow_tail);
 
 	// if (!m_victim_tail)
 	// 	return;
@@ -172,22 +498,56 @@ void worker<T>::grow_tail(task_deque<T> *tail)
 template <typename T>
 task_deque<T> *worker<T>::get_victim()
 {
-	auto i = xorshift_rand() % m_nvictims;
+	if (m_next_peer < m_npeers)
+		find_victims();
+
+	auto i = m_victim.next(m_nvictims);
 	return m_victims_heads[i];
 }
 
 template <typename T>
 void worker<T>::steal_loop()
 {
-	while (m_nvictims == 0)
-		std::this_thread::yield();
+	this_worker() = &m_context;
+
+#if STACCATO_PERF
+	m_perf.enter(perf_counters::in_scheduler);
+#endif
+
+	// The master's worker is published before any thread starts
+	find_victims();
+	STACCATO_ASSERT(m_nvictims > 0, "Worker started before the master");
+
+	m_stats.start();
+
+	if (deque_variant() == STACCATO_DEQUE_PRIVATE) {
+		while (!load_relaxed(m_stopped)) {
+			poll();
+
+			task_deque<T> *victim = nullptr;
+			auto t0 = read_tsc();
+			auto t = request_task(&victim);
+			count_steal_time(t, t0);
+
+			if (t) {
+				m_idle.reset();
+				t->process(this, m_head_deque);
+				victim->return_stolen();
+			} else {
+				idle_round();
+			}
+		}
+
+		m_stats.stop();
+		return;
+	}
 
 	auto vhead = get_victim();
 	auto vtail = vhead;
 	size_t now_stolen = 0;
 
 	while (!load_relaxed(m_stopped)) {
-		if (now_stolen >= m_taskgraph_degree - 1) {
+		if (now_stolen >= taskgraph_degree() - 1) {
 			if (vtail->get_next()) {
 				vtail = vtail->get_next();
 				now_stolen = 0;
@@ -195,7 +555,9 @@ void worker<T>::steal_loop()
 		}
 
 		bool was_empty = false;
+		auto t0 = read_tsc();
 		auto t = vtail->steal(&was_empty);
+		count_steal_time(t, t0);
 
 #if STACCATO_DEBUG
 		if (t)
@@ -206,7 +568,11 @@ void worker<T>::steal_loop()
 			COUNT(steal_race);
 #endif
 
+		m_stats.count(t ? stats_counters::steal : stats_counters::failed_steal);
+		trace(t ? trace_event::steal : trace_event::failed_steal);
+
 		if (t) {
+			m_idle.reset();
 			t->process(this, m_head_deque);
 			vtail->return_stolen();
 
@@ -221,13 +587,35 @@ void worker<T>::steal_loop()
 			continue;
 		}
 
-		if (vtail->get_next())
+		if (vtail->get_next()) {
 			vtail = vtail->get_next();
-		else
+		} else {
+			idle_round();
 			vtail = get_victim();
+		}
 
 		now_stolen = 0;
 	}
+
+	m_stats.stop();
+}
+
+template <typename T>
+inline void worker<T>::count_steal_time(bool stolen, uint64_t since)
+{
+	auto e = stolen ? stats_counters::steal_time : stats_counters::failed_steal_time;
+	m_stats.count(e, read_tsc() - since);
+}
+
+template <typename T>
+void worker<T>::idle_round()
+{
+	m_stats.count(stats_counters::idle);
+	trace(trace_event::idle);
+
+	auto t0 = read_tsc();
+	m_idle.idle();
+	m_stats.count(stats_counters::idle_time, read_tsc() - t0);
 }
 
 template <typename T>
@@ -236,6 +624,9 @@ void worker<T>::local_loop(task_deque<T> *tail)
 	task<T> *t = nullptr;
 	task_deque<T> *victim = nullptr;
 
+	// Only waits for stolen children are traced
+	bool waiting = false;
+
 	while (true) { // Local tasks loop
 		if (t) {
 			grow_tail(tail);
@@ -248,6 +639,8 @@ void worker<T>::local_loop(task_deque<T> *tail)
 			}
 		}
 
+		poll();
+
 		size_t nstolen = 0;
 
 		t = tail->take(&nstolen);
@@ -261,31 +654,52 @@ void worker<T>::local_loop(task_deque<T> *tail)
 			COUNT(take_stolen);
 #endif
 
-		if (t)
+		if (t) {
+			m_stats.count(stats_counters::take);
 			continue;
+		}
 
 		if (nstolen == 0)
-			return;
+			break;
+
+		if (!waiting) {
+			trace(trace_event::wait_begin);
+			waiting = true;
+		}
 
+		auto t0 = read_tsc();
 		t = steal_task(tail, &victim);
+		count_steal_time(t, t0);
 
-		if (!t)
-			std::this_thread::yield();
+		if (t) {
+			m_idle.reset();
+		} else {
+			idle_round();
+		}
 	}
+
+	if (waiting)
+		trace(trace_event::wait_end);
 }
 
 template <typename T>
 task<T> *worker<T>::steal_task(task_deque<T> *, task_deque<T> **victim)
 {
-	if (load_relaxed(m_nvictims) == 0)
+	if (m_next_peer < m_npeers)
+		find_victims();
+
+	if (m_nvictims == 0)
 		return nullptr;
 
+	if (deque_variant() == STACCATO_DEQUE_PRIVATE)
+		return request_task(victim);
+
 	auto vhead = get_victim();
 	auto vtail = vhead;
 	size_t now_stolen = 0;
 
 	while (true) {
-		if (now_stolen >= m_taskgraph_degree - 1) {
+		if (now_stolen >= taskgraph_degree() - 1) {
 			if (vtail->get_next()) {
 				vtail = vtail->get_next();
 				now_stolen = 0;
@@ -304,6 +718,9 @@ task<T> *worker<T>::steal_task(task_deque<T> *, task_deque<T> **victim)
 			COUNT(steal2_race);
 #endif
 
+		m_stats.count(t ? stats_counters::steal : stats_counters::failed_steal);
+		trace(t ? trace_event::steal : trace_event::failed_steal);
+
 		if (t) {
 			*victim = vtail;
 			return t;
@@ -323,11 +740,84 @@ task<T> *worker<T>::steal_task(task_deque<T> *, task_deque<T> **victim)
 	}
 }
 
+// The oldest task of the topmost non-empty level is handed over, as a
+// thief of shared deques would have taken it.
+template <typename T>
+void worker<T>::respond(worker<T> *thief)
+{
+	task<T> *t = nullptr;
+	auto d = m_head_deque;
+
+	for (; d; d = d->get_next()) {
+		t = d->transfer();
+		if (t)
+			break;
+	}
+
+	thief->m_transfer_task = t;
+	thief->m_transfer_deque = d;
+
+	// The thief may post a new request as soon as it gets the answer
+	store_relaxed(m_request, nullptr);
+	store_release(thief->m_transfer, t ? transfer_done : transfer_none);
+}
+
+template <typename T>
+task<T> *worker<T>::request_task(task_deque<T> **victim)
+{
+	if (m_next_peer < m_npeers)
+		find_victims();
+
+	auto v = m_victims[m_victim.next(m_nvictims)];
+
+	worker<T> *none = nullptr;
+	store_relaxed(m_transfer, transfer_wait);
+
+	if (load_relaxed(v->m_request) || !cas_strong(v->m_request, none, this)) {
+#if STACCATO_DEBUG
+		COUNT(steal_race);
+#endif
+		m_stats.count(stats_counters::failed_steal);
+		trace(trace_event::failed_steal);
+		return nullptr;
+	}
+
+	// Requests to this worker are answered while waiting, otherwise two
+	// workers asking each other would never get an answer
+	while (load_acquire(m_transfer) == transfer_wait) {
+		poll();
+
+		if (load_relaxed(m_stopped))
+			return nullptr;
+	}
+
+	if (load_relaxed(m_transfer) == transfer_none) {
+#if STACCATO_DEBUG
+		COUNT(steal_empty);
+#endif
+		m_stats.count(stats_counters::failed_steal);
+		trace(trace_event::failed_steal);
+		return nullptr;
+	}
+
+#if STACCATO_DEBUG
+	COUNT(steal);
+#endif
+	m_stats.count(stats_counters::steal);
+	trace(trace_event::steal);
+
+	*victim = m_transfer_deque;
+	return m_transfer_task;
+}
+
 #if STACCATO_DEBUG
 
 template <typename T>
 void worker<T>::print_counters()
 {
+	for (auto d = m_head_deque; d; d = d->get_next())
+		m_counter.count(counter::publish, d->npublished());
+
 	m_counter.print(m_id);
 } 
 #endif
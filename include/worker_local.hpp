@@ -0,0 +1,177 @@
+#ifndef WORKER_LOCAL_HPP_5FQX0ZTA
+#define WORKER_LOCAL_HPP_5FQX0ZTA
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+
+#include "utils.hpp"
+#include "worker.hpp"
+#include "scheduler.hpp"
+
+namespace staccato
+{
+
+// One value of V per worker of a scheduler. A worker's value is copied
+// from the exemplar when the worker first calls local(). It takes a cache
+// line of its own from the worker's allocator and is touched first by that
+// worker, so with first-touch placement it ends up on the worker's NUMA
+// node.
+//
+// local() may only be called from tasks of the scheduler, and the object
+// must not outlive it. Created values can be iterated over after wait().
+template <typename V>
+class worker_local
+{
+	struct STACCATO_ALIGN padded_value
+	{
+		padded_value(const V &v): value(v)
+		{ }
+
+		V value;
+	};
+
+public:
+	template <typename T, size_t D, size_t H, typename P>
+	worker_local(const scheduler<T, D, H, P> &sh, const V &exemplar = V());
+
+	~worker_local();
+
+	worker_local(const worker_local &) = delete;
+	worker_local &operator=(const worker_local &) = delete;
+
+	V &local();
+
+	class iterator
+	{
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef V value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef V *pointer;
+		typedef V &reference;
+
+		iterator(padded_value **cur, padded_value **end)
+		: m_cur(cur), m_end(end)
+		{
+			skip();
+		}
+
+		V &operator*() const { return (*m_cur)->value; }
+		V *operator->() const { return &(*m_cur)->value; }
+
+		iterator &operator++() {
+			++m_cur;
+			skip();
+			return *this;
+		}
+
+		bool operator==(const iterator &o) const { return m_cur == o.m_cur; }
+		bool operator!=(const iterator &o) const { return m_cur != o.m_cur; }
+
+	private:
+		void skip() {
+			while (m_cur != m_end && !*m_cur)
+				++m_cur;
+		}
+
+		padded_value **m_cur;
+		padded_value **m_end;
+	};
+
+	// Values in worker order, skipping workers that have not created one
+	iterator begin();
+	iterator end();
+
+	// Number of created values
+	size_t size() const;
+
+	bool empty() const;
+
+	// init op v0 op v1 ... over created values in worker order
+	template <typename Op>
+	V combine(V init, Op op) const;
+
+private:
+	const size_t m_nworkers;
+	const V m_exemplar;
+
+	padded_value **m_values;
+};
+
+template <typename V>
+template <typename T, size_t D, size_t H, typename P>
+worker_local<V>::worker_local(const scheduler<T, D, H, P> &sh, const V &exemplar)
+: m_nworkers(sh.nworkers())
+, m_exemplar(exemplar)
+, m_values(new padded_value *[m_nworkers]())
+{ }
+
+template <typename V>
+worker_local<V>::~worker_local()
+{
+	// The memory itself belongs to the workers' allocators
+	for (size_t i = 0; i < m_nworkers; ++i)
+		if (m_values[i])
+			m_values[i]->~padded_value();
+
+	delete []m_values;
+}
+
+template <typename V>
+V &worker_local<V>::local()
+{
+	auto ctx = internal::this_worker();
+
+	STACCATO_ASSERT(ctx, "worker_local is accessed outside of a task");
+	STACCATO_ASSERT(ctx->id < m_nworkers, "worker_local of another scheduler");
+
+	auto &v = m_values[ctx->id];
+	if (!v)
+		v = new(ctx->alloc<padded_value>()) padded_value(m_exemplar);
+
+	return v->value;
+}
+
+template <typename V>
+typename worker_local<V>::iterator worker_local<V>::begin()
+{
+	return iterator(m_values, m_values + m_nworkers);
+}
+
+template <typename V>
+typename worker_local<V>::iterator worker_local<V>::end()
+{
+	return iterator(m_values + m_nworkers, m_values + m_nworkers);
+}
+
+template <typename V>
+size_t worker_local<V>::size() const
+{
+	size_t n = 0;
+	for (size_t i = 0; i < m_nworkers; ++i)
+		if (m_values[i])
+			n++;
+	return n;
+}
+
+template <typename V>
+bool worker_local<V>::empty() const
+{
+	return size() == 0;
+}
+
+template <typename V>
+template <typename Op>
+V worker_local<V>::combine(V init, Op op) const
+{
+	for (size_t i = 0; i < m_nworkers; ++i)
+		if (m_values[i])
+			init = op(init, m_values[i]->value);
+
+	return init;
+}
+
+} /* staccato */
+
+#endif /* end of include guard: WORKER_LOCAL_HPP_5FQX0ZTA */
@@ -0,0 +1,212 @@
+#ifndef WORKSPAN_HPP_R7DK2MVX
+#define WORKSPAN_HPP_R7DK2MVX
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+
+#include "utils.hpp"
+
+namespace staccato
+{
+
+// Work and span of a root task in TSC cycles. The burdened span also
+// charges STACCATO_WORKSPAN_BURDEN cycles for every steal on the critical
+// path, as Cilkview does.
+struct workspan
+{
+	uint64_t work;
+	uint64_t span;
+	uint64_t burdened_span;
+
+	double parallelism() const {
+		return span ? double(work) / span : 0;
+	}
+
+	double burdened_parallelism() const {
+		return burdened_span ? double(work) / burdened_span : 0;
+	}
+
+	// No schedule on p workers is faster than this
+	double speedup_upper_bound(size_t p) const {
+		return std::min(double(p), parallelism());
+	}
+
+	// Work stealing on p workers should do at least this well, as long as
+	// a steal costs less than the burden
+	double speedup_lower_bound(size_t p) const {
+		return work ? work / (double(work) / p + burdened_span) : 0;
+	}
+};
+
+namespace internal
+{
+
+// Work and span of a task along the fork-join DAG, measured while it runs.
+// Time between scheduler calls of the task is a strand and counts to both.
+// A spawned child starts at the span of its parent at the spawn and adds
+// its end to the parent when it finishes, on whatever worker that is; the
+// parent takes the latest end at wait(). Called children are serial.
+class workspan_frame
+{
+public:
+	workspan_frame();
+
+	void begin();
+
+	// Before and after the task leaves its strand for the scheduler
+	void pause();
+	void resume();
+
+	void spawn(workspan_frame *child);
+
+	void add_called(const workspan_frame &child);
+
+	void sync();
+
+	void end();
+
+	workspan result() const;
+
+private:
+	static void update_max(std::atomic<uint64_t> &a, uint64_t v);
+
+	workspan_frame *m_parent;
+	uint64_t m_spawn_span;
+	uint64_t m_spawn_burdened_span;
+
+	uint64_t m_start;
+	uint64_t m_work;
+	uint64_t m_span;
+	uint64_t m_burdened_span;
+
+	// Updated by spawned children that may run on other workers
+	std::atomic<uint64_t> m_children_work;
+	std::atomic<uint64_t> m_children_span;
+	std::atomic<uint64_t> m_children_burdened_span;
+};
+
+workspan_frame::workspan_frame()
+: m_parent(nullptr)
+, m_spawn_span(0)
+, m_spawn_burdened_span(0)
+, m_start(0)
+, m_work(0)
+, m_span(0)
+, m_burdened_span(0)
+, m_children_work(0)
+, m_children_span(0)
+, m_children_burdened_span(0)
+{ }
+
+inline void workspan_frame::begin()
+{
+	m_work = 0;
+	m_span = 0;
+	m_burdened_span = 0;
+	store_relaxed(m_children_work, 0);
+	store_relaxed(m_children_span, 0);
+	store_relaxed(m_children_burdened_span, 0);
+
+	m_start = read_tsc();
+}
+
+inline void workspan_frame::pause()
+{
+	auto d = read_tsc() - m_start;
+
+	m_work += d;
+	m_span += d;
+	m_burdened_span += d;
+}
+
+inline void workspan_frame::resume()
+{
+	m_start = read_tsc();
+}
+
+inline void workspan_frame::spawn(workspan_frame *child)
+{
+	pause();
+
+	child->m_parent = this;
+	child->m_spawn_span = m_span;
+	child->m_spawn_burdened_span = m_burdened_span;
+
+	resume();
+}
+
+inline void workspan_frame::add_called(const workspan_frame &child)
+{
+	m_work += child.m_work;
+	m_span += child.m_span;
+	m_burdened_span += child.m_burdened_span;
+}
+
+// Children have returned, so their updates are visible
+inline void workspan_frame::sync()
+{
+	m_work += load_relaxed(m_children_work);
+	m_span = std::max(m_span, load_relaxed(m_children_span));
+	m_burdened_span = std::max(m_burdened_span,
+		load_relaxed(m_children_burdened_span));
+
+	store_relaxed(m_children_work, 0);
+	store_relaxed(m_children_span, 0);
+	store_relaxed(m_children_burdened_span, 0);
+}
+
+inline void workspan_frame::end()
+{
+	pause();
+	sync();
+
+	if (!m_parent)
+		return;
+
+	m_parent->m_children_work.fetch_add(m_work, std::memory_order_relaxed);
+	update_max(m_parent->m_children_span, m_spawn_span + m_span);
+	update_max(m_parent->m_children_burdened_span,
+		m_spawn_burdened_span + STACCATO_WORKSPAN_BURDEN + m_burdened_span);
+}
+
+workspan workspan_frame::result() const
+{
+	workspan r;
+	r.work = m_work;
+	r.span = m_span;
+	r.burdened_span = m_burdened_span;
+	return r;
+}
+
+inline void workspan_frame::update_max(std::atomic<uint64_t> &a, uint64_t v)
+{
+	auto cur = load_relaxed(a);
+	while (cur < v && !a.compare_exchange_weak(cur, v, std::memory_order_relaxed))
+		;
+}
+
+inline void print_workspan(size_t root, const workspan &ws, size_t nworkers)
+{
+	FILE *fp = stdout;
+
+	fprintf(fp, "[STACCATO] root %lu: work %llu, span %llu, burdened span %llu\n",
+		root,
+		static_cast<unsigned long long>(ws.work),
+		static_cast<unsigned long long>(ws.span),
+		static_cast<unsigned long long>(ws.burdened_span));
+
+	fprintf(fp, "[STACCATO] root %lu: parallelism %.2f, burdened parallelism %.2f\n",
+		root, ws.parallelism(), ws.burdened_parallelism());
+
+	fprintf(fp, "[STACCATO] root %lu: speedup on %lu workers %.2f to %.2f\n",
+		root, nworkers, ws.speedup_lower_bound(nworkers),
+		ws.speedup_upper_bound(nworkers));
+}
+
+} /* internal */
+} /* staccato */
+
+#endif /* end of include guard: WORKSPAN_HPP_R7DK2MVX */
@@ -3,6 +3,7 @@
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <cstring>
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -39,3 +40,45 @@ TEST(alloc_dealloc, no_reize) {
 	delete a;
 }
 
+
+TEST(mark_rewind, reuses_memory) {
+	auto a = new lifo_allocator(2048);
+
+	a->alloc<size_t>();
+
+	auto m = a->mark();
+	auto first = a->alloc<size_t>();
+
+	for (size_t i = 0; i < 1000; ++i)
+		*a->alloc<size_t>() = i;
+
+	a->rewind(m);
+
+	EXPECT_EQ(a->alloc<size_t>(), first);
+
+	a->rewind(m);
+
+	// Pages allocated before the rewind are reused
+	std::vector<size_t *> ptrs;
+	for (size_t i = 0; i < 1000; ++i) {
+		ptrs.push_back(a->alloc<size_t>());
+		*ptrs.back() = i;
+	}
+
+	for (size_t i = 0; i < 1000; ++i)
+		EXPECT_EQ(*ptrs[i], i);
+
+	delete a;
+}
+
+TEST(alloc_dealloc, larger_than_page) {
+	auto a = new lifo_allocator(4096);
+
+	auto p = a->alloc_array<uint8_t>(3 * 4096);
+	memset(p, 0xff, 3 * 4096);
+
+	auto q = a->alloc_array<uint8_t>(4096);
+	memset(q, 0xff, 4096);
+
+	delete a;
+}
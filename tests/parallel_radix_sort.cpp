@@ -0,0 +1,102 @@
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "parallel_radix_sort.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+static uint64_t next_rand(uint64_t &x)
+{
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	return x * 2685821657736338717ull;
+}
+
+TEST(parallel_radix_sort, keys) {
+	for (size_t n : {0ul, 1ul, 50ul, 1000ul, 100000ul, 1000003ul}) {
+		uint64_t x = 88172645463325252ull;
+		std::vector<uint64_t> v(n);
+		for (auto &k : v)
+			k = next_rand(x);
+
+		auto expected = v;
+		std::sort(expected.begin(), expected.end());
+
+		parallel_radix_sort(v.data(), n, nthreads);
+
+		EXPECT_EQ(v, expected) << "n = " << n;
+	}
+}
+
+TEST(parallel_radix_sort, narrow_and_equal_keys) {
+	size_t n = 300000;
+
+	std::vector<uint32_t> v(n);
+	for (size_t i = 0; i < n; ++i)
+		v[i] = (n - i) % 1000;
+
+	auto expected = v;
+	std::sort(expected.begin(), expected.end());
+
+	parallel_radix_sort(v.data(), n, nthreads);
+	EXPECT_EQ(v, expected);
+
+	std::vector<uint16_t> e(n, 7);
+	parallel_radix_sort(e.data(), n, nthreads);
+	EXPECT_EQ(e, std::vector<uint16_t>(n, 7));
+}
+
+TEST(parallel_radix_sort, skewed_keys_are_stable) {
+	size_t n = 500000;
+	uint64_t x = 88172645463325252ull;
+
+	// Most keys are small, so the top digit is skewed and the MSD path
+	// is taken
+	std::vector<uint64_t> keys(n);
+	std::vector<uint32_t> values(n);
+	for (size_t i = 0; i < n; ++i) {
+		auto r = next_rand(x);
+		keys[i] = (i % 10) ? r % 5000 : r;
+		values[i] = i;
+	}
+
+	std::vector<std::pair<uint64_t, uint32_t>> expected(n);
+	for (size_t i = 0; i < n; ++i)
+		expected[i] = std::make_pair(keys[i], values[i]);
+	std::stable_sort(expected.begin(), expected.end(),
+		[](const std::pair<uint64_t, uint32_t> &a, const std::pair<uint64_t, uint32_t> &b) {
+			return a.first < b.first;
+		});
+
+	parallel_radix_sort(keys.data(), values.data(), n, nthreads);
+
+	for (size_t i = 0; i < n; ++i) {
+		ASSERT_EQ(keys[i], expected[i].first) << "i = " << i;
+		ASSERT_EQ(values[i], expected[i].second) << "i = " << i;
+	}
+}
+
+TEST(parallel_radix_sort, key_value_pairs) {
+	size_t n = 777777;
+	uint64_t x = 88172645463325252ull;
+
+	std::vector<uint64_t> keys(n);
+	std::vector<double> values(n);
+	for (size_t i = 0; i < n; ++i) {
+		keys[i] = next_rand(x) >> 3;
+		values[i] = keys[i] * 0.5;
+	}
+
+	parallel_radix_sort(keys.data(), values.data(), n, nthreads);
+
+	for (size_t i = 1; i < n; ++i)
+		ASSERT_LE(keys[i - 1], keys[i]);
+	for (size_t i = 0; i < n; ++i)
+		ASSERT_EQ(values[i], keys[i] * 0.5);
+}
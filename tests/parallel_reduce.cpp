@@ -0,0 +1,58 @@
+#include <thread>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "parallel_reduce.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+TEST(parallel_reduce, sum) {
+	size_t n = 100000;
+
+	auto map = [](size_t i) { return static_cast<unsigned long>(i); };
+	auto plus = [](unsigned long a, unsigned long b) { return a + b; };
+
+	auto r = parallel_reduce(range(0, n, 64), 0ul, map, plus, nthreads);
+
+	EXPECT_EQ(r, n * (n - 1) / 2);
+}
+
+TEST(parallel_reduce, empty_range) {
+	auto map = [](size_t i) { return static_cast<int>(i); };
+	auto plus = [](int a, int b) { return a + b; };
+
+	EXPECT_EQ(parallel_reduce(range(5, 5), 42, map, plus, nthreads), 42);
+	EXPECT_EQ(deterministic_parallel_reduce(range(5, 5), 42, map, plus, nthreads), 42);
+}
+
+TEST(parallel_reduce, combine_order) {
+	size_t n = 1000;
+
+	auto map = [](size_t i) { return std::to_string(i % 10); };
+	auto concat = [](const std::string &a, const std::string &b) { return a + b; };
+
+	std::string expected;
+	for (size_t i = 0; i < n; ++i)
+		expected += std::to_string(i % 10);
+
+	auto r = parallel_reduce(range(0, n, 7), std::string(), map, concat, nthreads);
+	EXPECT_EQ(r, expected);
+}
+
+TEST(deterministic_parallel_reduce, bitwise_reproducible) {
+	size_t n = 1 << 18;
+
+	auto map = [](size_t i) { return 1.0 / (1.0 + i); };
+	auto plus = [](double a, double b) { return a + b; };
+
+	auto expected = deterministic_parallel_reduce(range(0, n, 100), 0.0, map, plus, 1);
+
+	for (size_t t = 2; t <= 2 * nthreads; ++t) {
+		auto r = deterministic_parallel_reduce(range(0, n, 100), 0.0, map, plus, t);
+		EXPECT_EQ(0, memcmp(&r, &expected, sizeof(r)));
+	}
+}
@@ -0,0 +1,69 @@
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <functional>
+
+#include "gtest/gtest.h"
+
+#include "parallel_scan.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+template <typename T>
+static std::vector<T> make_input(size_t n)
+{
+	std::vector<T> v(n);
+	for (size_t i = 0; i < n; ++i)
+		v[i] = static_cast<T>((i * 7919) % 13);
+	return v;
+}
+
+TEST(parallel_inclusive_scan, int64) {
+	for (size_t n : {1ul, 3ul, 4ul, 1000ul, 100003ul, 1000000ul}) {
+		auto in = make_input<int64_t>(n);
+		std::vector<int64_t> out(n);
+
+		parallel_inclusive_scan(in.data(), in.data() + n, out.data(),
+			int64_t(0), std::plus<int64_t>(), nthreads);
+
+		int64_t s = 0;
+		for (size_t i = 0; i < n; ++i) {
+			s += in[i];
+			ASSERT_EQ(out[i], s) << "n = " << n << ", i = " << i;
+		}
+	}
+}
+
+TEST(parallel_exclusive_scan, in_place) {
+	size_t n = 1000003;
+	auto in = make_input<int32_t>(n);
+	auto data = in;
+
+	parallel_exclusive_scan(data.data(), data.data() + n, data.data(),
+		int32_t(5), std::plus<int32_t>(), nthreads);
+
+	int32_t s = 5;
+	for (size_t i = 0; i < n; ++i) {
+		ASSERT_EQ(data[i], s) << "i = " << i;
+		s += in[i];
+	}
+}
+
+TEST(parallel_inclusive_scan, custom_op) {
+	size_t n = 300000;
+	auto in = make_input<uint64_t>(n);
+	std::vector<uint64_t> out(n);
+
+	auto op = [](uint64_t a, uint64_t b) { return a > b ? a : b; };
+
+	parallel_inclusive_scan(in.data(), in.data() + n, out.data(),
+		uint64_t(0), op, nthreads);
+
+	uint64_t m = 0;
+	for (size_t i = 0; i < n; ++i) {
+		m = std::max(m, in[i]);
+		ASSERT_EQ(out[i], m);
+	}
+}
@@ -0,0 +1,66 @@
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "parallel_sort.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+static std::vector<int> make_input(size_t n, int range)
+{
+	std::vector<int> v(n);
+	uint32_t x = 2463534242;
+	for (size_t i = 0; i < n; ++i) {
+		x ^= x >> 13;
+		x ^= x << 17;
+		x ^= x >> 5;
+		v[i] = x % range;
+	}
+	return v;
+}
+
+TEST(parallel_sort, sizes) {
+	for (size_t n : {0ul, 1ul, 100ul, 8193ul, 100000ul, 1000003ul}) {
+		auto v = make_input(n, 1 << 20);
+		auto expected = v;
+		std::sort(expected.begin(), expected.end());
+
+		parallel_sort(v.begin(), v.end(), std::less<int>(), nthreads);
+
+		EXPECT_EQ(v, expected) << "n = " << n;
+	}
+}
+
+TEST(parallel_sort, duplicates_and_comparator) {
+	size_t n = 500000;
+	auto v = make_input(n, 16);
+	auto expected = v;
+	std::sort(expected.begin(), expected.end(), std::greater<int>());
+
+	parallel_sort(v.begin(), v.end(), std::greater<int>(), nthreads);
+
+	EXPECT_EQ(v, expected);
+}
+
+TEST(parallel_sort, pairs_by_key) {
+	size_t n = 300000;
+	auto keys = make_input(n, 64);
+
+	std::vector<std::pair<int, size_t>> v(n);
+	for (size_t i = 0; i < n; ++i)
+		v[i] = std::make_pair(keys[i], i);
+
+	auto by_key = [](const std::pair<int, size_t> &a, const std::pair<int, size_t> &b) {
+		return a.first < b.first;
+	};
+
+	parallel_sort(v.begin(), v.end(), by_key, nthreads);
+
+	for (size_t i = 1; i < n; ++i)
+		ASSERT_LE(v[i - 1].first, v[i].first);
+}
@@ -0,0 +1,75 @@
+#define STACCATO_PERF 1
+
+#include <unistd.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+// Leaves sleep, so every leaf switches context in task code
+class SleepTask: public task<SleepTask>
+{
+public:
+	SleepTask(int depth): depth(depth)
+	{ }
+
+	void execute() {
+		if (depth == 0) {
+			usleep(100);
+			return;
+		}
+
+		spawn(new(child()) SleepTask(depth - 1));
+		spawn(new(child()) SleepTask(depth - 1));
+
+		wait();
+	}
+
+private:
+	int depth;
+};
+
+static worker_stats total(const std::vector<worker_stats> &v)
+{
+	worker_stats r = worker_stats();
+	for (auto &s : v)
+		r += s;
+	return r;
+}
+
+TEST(perf, context_switches_in_tasks) {
+	scheduler<SleepTask> sh(2, nthreads);
+
+	sh.spawn(new(sh.root()) SleepTask(5));
+	sh.wait();
+
+	auto s = total(sh.stats());
+
+	if (s.task_perf.context_switches + s.scheduler_perf.context_switches == 0)
+		GTEST_SKIP() << "Context switches can't be counted";
+
+	EXPECT_GE(s.task_perf.context_switches, 32ul);
+}
+
+TEST(perf, cycles_split) {
+	scheduler<SleepTask> sh(2, nthreads);
+
+	sh.spawn(new(sh.root()) SleepTask(5));
+	sh.wait();
+
+	auto s = total(sh.stats());
+
+	if (s.task_perf.cycles + s.scheduler_perf.cycles == 0)
+		GTEST_SKIP() << "Hardware events can't be counted";
+
+	EXPECT_GT(s.task_perf.cycles, 0ul);
+	EXPECT_GT(s.task_perf.instructions, 0ul);
+	EXPECT_GT(s.scheduler_perf.cycles, 0ul);
+}
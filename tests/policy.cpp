@@ -0,0 +1,95 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+#include "worker_local.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+template <typename Policy>
+class TreeTask: public task<TreeTask<Policy>>
+{
+public:
+	typedef Policy scheduler_policy;
+
+	TreeTask(size_t depth, unsigned long *sum)
+	: depth(depth), sum(sum)
+	{ }
+
+	// Leaves counted per worker, if set
+	static worker_local<unsigned long> *leaves;
+
+	void execute() {
+		if (depth == 0) {
+			if (leaves)
+				leaves->local()++;
+
+			*sum = 1;
+			return;
+		}
+
+		unsigned long x, y, z;
+		this->spawn(new(this->child()) TreeTask(depth - 1, &x));
+		this->spawn(new(this->child()) TreeTask(depth - 1, &y));
+		this->call(new(this->child()) TreeTask(depth - 1, &z));
+
+		this->wait();
+
+		*sum = x + y + z;
+	}
+
+private:
+	size_t depth;
+	unsigned long *sum;
+};
+
+template <typename Policy>
+worker_local<unsigned long> *TreeTask<Policy>::leaves = nullptr;
+
+template <typename Policy>
+class policy_test: public ::testing::Test
+{ };
+
+typedef ::testing::Types<
+	default_policy,
+	policy<random_victim, yield_idle, shared_deque, lifo_allocator>,
+	policy<round_robin_victim, spin_idle, shared_deque, lifo_allocator>,
+	policy<random_victim, backoff_idle, private_deque, lifo_allocator>,
+	policy<round_robin_victim, yield_idle, split_deque, heap_allocator>,
+	policy<random_victim, backoff_idle, shared_deque, heap_allocator>
+> policies;
+
+TYPED_TEST_CASE(policy_test, policies);
+
+TYPED_TEST(policy_test, tree) {
+	typedef TreeTask<TypeParam> task_t;
+
+	unsigned long answer = 0;
+
+	scheduler<task_t> sh(3, nthreads);
+	sh.spawn(new(sh.root()) task_t(9, &answer));
+	sh.wait();
+
+	EXPECT_EQ(answer, 19683ul);
+}
+
+TYPED_TEST(policy_test, worker_local) {
+	typedef TreeTask<TypeParam> task_t;
+
+	unsigned long answer = 0;
+
+	scheduler<task_t, 0, 0, TypeParam> sh(3, nthreads);
+	worker_local<unsigned long> leaves(sh, 0);
+
+	task_t::leaves = &leaves;
+	sh.spawn(new(sh.root()) task_t(6, &answer));
+	sh.wait();
+	task_t::leaves = nullptr;
+
+	EXPECT_EQ(answer, 729ul);
+	EXPECT_EQ(leaves.combine(0ul, std::plus<unsigned long>()), 729ul);
+}
@@ -0,0 +1,123 @@
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "reducer.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+typedef reducer<unsigned long> sum_reducer;
+
+class SumTask: public task<SumTask>
+{
+public:
+	SumTask(sum_reducer *r, size_t first, size_t last)
+	: r(r), first(first), last(last)
+	{ }
+
+	void execute() {
+		if (last - first <= 16) {
+			for (size_t i = first; i < last; ++i)
+				r->view() += i;
+			return;
+		}
+
+		auto mid = first + (last - first) / 2;
+
+		spawn(new(child()) SumTask(r, first, mid));
+		spawn(new(child()) SumTask(r, mid, last));
+
+		wait();
+	}
+
+private:
+	sum_reducer *r;
+	size_t first;
+	size_t last;
+};
+
+TEST(reducer, sum) {
+	size_t n = 100000;
+
+	scheduler<SumTask> sh(2, nthreads, 16);
+	sum_reducer r(sh);
+
+	sh.spawn(new(sh.root()) SumTask(&r, 0, n));
+	sh.wait();
+
+	EXPECT_EQ(r.get(), n * (n - 1) / 2);
+
+	// Views are kept between runs
+	sh.spawn(new(sh.root()) SumTask(&r, 0, n));
+	sh.wait();
+
+	EXPECT_EQ(r.get(), n * (n - 1));
+}
+
+TEST(reducer, identity) {
+	scheduler<SumTask> sh(2, nthreads);
+	reducer<int> r(sh, 42);
+
+	EXPECT_EQ(r.get(), 42);
+}
+
+struct concat
+{
+	std::vector<size_t> operator()(
+		std::vector<size_t> a,
+		const std::vector<size_t> &b
+	) const {
+		a.insert(a.end(), b.begin(), b.end());
+		return a;
+	}
+};
+
+typedef reducer<std::vector<size_t>, concat> list_reducer;
+
+class ListTask: public task<ListTask>
+{
+public:
+	ListTask(list_reducer *r, size_t first, size_t last)
+	: r(r), first(first), last(last)
+	{ }
+
+	void execute() {
+		if (last - first == 1) {
+			r->view().push_back(first);
+			return;
+		}
+
+		auto mid = first + (last - first) / 2;
+
+		spawn(new(child()) ListTask(r, first, mid));
+		spawn(new(child()) ListTask(r, mid, last));
+
+		wait();
+	}
+
+private:
+	list_reducer *r;
+	size_t first;
+	size_t last;
+};
+
+TEST(reducer, non_trivial_views) {
+	size_t n = 10000;
+
+	scheduler<ListTask> sh(2, nthreads, 16);
+	list_reducer r(sh);
+
+	sh.spawn(new(sh.root()) ListTask(&r, 0, n));
+	sh.wait();
+
+	auto v = r.get();
+	std::sort(v.begin(), v.end());
+
+	ASSERT_EQ(v.size(), n);
+	for (size_t i = 0; i < n; ++i)
+		EXPECT_EQ(v[i], i);
+}
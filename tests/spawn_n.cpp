@@ -0,0 +1,72 @@
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+class TreeTask: public task<TreeTask>
+{
+public:
+	TreeTask(size_t depth, size_t breadth, bool use_call, unsigned long *sum)
+	: depth(depth), breadth(breadth), use_call(use_call), sum(sum)
+	{ }
+
+	void execute() {
+		if (depth == 0) {
+			*sum = 1;
+			return;
+		}
+
+		auto sums = scratch<unsigned long>(breadth);
+		size_t nspawn = use_call ? breadth - 1 : breadth;
+
+		for (size_t i = 0; i < nspawn; ++i)
+			new(child(i)) TreeTask(depth - 1, breadth, use_call, sums + i);
+
+		spawn_n(nspawn);
+
+		if (use_call)
+			call(new(child()) TreeTask(depth - 1, breadth, use_call, sums + nspawn));
+
+		wait();
+
+		*sum = 0;
+		for (size_t i = 0; i < breadth; ++i)
+			*sum += sums[i];
+	}
+
+private:
+	size_t depth;
+	size_t breadth;
+	bool use_call;
+	unsigned long *sum;
+};
+
+unsigned long count_leaves(size_t depth, size_t breadth, bool use_call)
+{
+	unsigned long answer = 0;
+
+	scheduler<TreeTask> sh(breadth, nthreads);
+	sh.spawn(new(sh.root()) TreeTask(depth, breadth, use_call, &answer));
+	sh.wait();
+
+	return answer;
+}
+
+TEST(spawn_n, tree) {
+	EXPECT_EQ(count_leaves(6, 8, false), 262144ul);
+	EXPECT_EQ(count_leaves(3, 32, false), 32768ul);
+	EXPECT_EQ(count_leaves(4, 5, false), 625ul);
+}
+
+TEST(spawn_n, with_call) {
+	EXPECT_EQ(count_leaves(6, 8, true), 262144ul);
+	EXPECT_EQ(count_leaves(3, 32, true), 32768ul);
+	EXPECT_EQ(count_leaves(4, 5, true), 625ul);
+}
@@ -0,0 +1,71 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+// Degree 5 is rounded up to 8 slots per level
+class TreeTask: public task<TreeTask>
+{
+public:
+	static constexpr size_t taskgraph_degree = 5;
+
+	TreeTask(size_t depth, unsigned long *sum)
+	: depth(depth), sum(sum)
+	{ }
+
+	void execute() {
+		if (depth == 0) {
+			*sum = 1;
+			return;
+		}
+
+		unsigned long sums[taskgraph_degree];
+
+		for (size_t i = 0; i < taskgraph_degree - 1; ++i)
+			new(child(i)) TreeTask(depth - 1, sums + i);
+
+		spawn_n(taskgraph_degree - 1);
+
+		call(new(child()) TreeTask(depth - 1, sums + taskgraph_degree - 1));
+
+		wait();
+
+		*sum = 0;
+		for (size_t i = 0; i < taskgraph_degree; ++i)
+			*sum += sums[i];
+	}
+
+private:
+	size_t depth;
+	unsigned long *sum;
+};
+
+static_assert(internal::static_degree<TreeTask>::value == 8,
+	"Static degree is not rounded up");
+
+TEST(static_degree, tree) {
+	unsigned long answer = 0;
+
+	scheduler<TreeTask> sh(nthreads);
+	sh.spawn(new(sh.root()) TreeTask(6, &answer));
+	sh.wait();
+
+	EXPECT_EQ(answer, 15625ul);
+}
+
+TEST(static_degree, static_height) {
+	unsigned long answer = 0;
+
+	scheduler<TreeTask, 5, 8> sh(nthreads);
+	sh.spawn(new(sh.root()) TreeTask(8, &answer));
+	sh.wait();
+
+	EXPECT_EQ(answer, 390625ul);
+	EXPECT_EQ(sh.nworkers(), nthreads);
+}
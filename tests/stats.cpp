@@ -0,0 +1,132 @@
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+class FibTask: public task<FibTask>
+{
+public:
+	FibTask(int n, long *sum): n(n), sum(sum)
+	{ }
+
+	void execute() {
+		if (n <= 2) {
+			*sum = 1;
+			return;
+		}
+
+		long x, y;
+		spawn(new(child()) FibTask(n - 1, &x));
+		spawn(new(child()) FibTask(n - 2, &y));
+
+		wait();
+
+		*sum = x + y;
+	}
+
+private:
+	int n;
+	long *sum;
+};
+
+static worker_stats total(const std::vector<worker_stats> &v)
+{
+	worker_stats r = worker_stats();
+	for (auto &s : v)
+		r += s;
+	return r;
+}
+
+TEST(stats, every_spawn_is_taken_or_stolen) {
+	long answer = 0;
+
+	scheduler<FibTask> sh(2, nthreads);
+
+	auto before = total(sh.stats());
+	EXPECT_EQ(before.spawns, 0ul);
+	EXPECT_EQ(before.takes, 0ul);
+
+	sh.spawn(new(sh.root()) FibTask(20, &answer));
+	sh.wait();
+
+	EXPECT_EQ(answer, 6765);
+
+	auto s = sh.stats();
+	EXPECT_EQ(s.size(), nthreads);
+
+	// fib(20) tree has 2 * fib(20) - 1 tasks, the root included
+	auto t = total(s);
+	EXPECT_EQ(t.spawns, 2ul * 6765 - 1);
+	EXPECT_EQ(t.takes + t.steals, t.spawns);
+}
+
+TEST(stats, read_while_running) {
+	long answer = 0;
+
+	scheduler<FibTask> sh(2, nthreads);
+
+	std::atomic_bool done(false);
+	bool monotonic = true;
+
+	std::thread reader([&] {
+		worker_stats prev = worker_stats();
+		while (!done) {
+			auto t = total(sh.stats());
+			if (t.spawns < prev.spawns || t.takes < prev.takes)
+				monotonic = false;
+			prev = t;
+			std::this_thread::yield();
+		}
+	});
+
+	sh.spawn(new(sh.root()) FibTask(25, &answer));
+	sh.wait();
+
+	done = true;
+	reader.join();
+
+	EXPECT_EQ(answer, 75025);
+	EXPECT_TRUE(monotonic);
+}
+
+TEST(stats, time_breakdown) {
+	long answer = 0;
+
+	scheduler<FibTask> sh(2, nthreads);
+	sh.spawn(new(sh.root()) FibTask(20, &answer));
+	sh.wait();
+
+	EXPECT_EQ(answer, 6765);
+
+	auto s = sh.stats();
+	EXPECT_GT(s[0].cycles, 0ul);
+	EXPECT_GT(s[0].work_cycles(), 0ul);
+
+	for (auto &w : s) {
+		EXPECT_GE(w.cycles,
+			w.steal_cycles + w.failed_steal_cycles + w.idle_cycles);
+	}
+}
+
+TEST(stats, single_worker_never_steals) {
+	long answer = 0;
+
+	scheduler<FibTask> sh(2, 1);
+	sh.spawn(new(sh.root()) FibTask(20, &answer));
+	sh.wait();
+
+	auto s = sh.stats();
+	ASSERT_EQ(s.size(), 1ul);
+	EXPECT_EQ(s[0].steal_cycles, 0ul);
+	EXPECT_EQ(s[0].failed_steal_cycles, 0ul);
+	EXPECT_EQ(s[0].idle_cycles, 0ul);
+	EXPECT_EQ(s[0].work_cycles(), s[0].cycles);
+}
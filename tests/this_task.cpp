@@ -0,0 +1,65 @@
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+class FibTask;
+
+// Library code that forks without being given the task object
+void fib(int n, long *sum);
+
+class FibTask: public task<FibTask>
+{
+public:
+	FibTask(int n, long *sum): n(n), sum(sum)
+	{ }
+
+	void execute() {
+		EXPECT_EQ(task<FibTask>::current(), this);
+
+		fib(n, sum);
+
+		EXPECT_EQ(task<FibTask>::current(), this);
+	}
+
+private:
+	int n;
+	long *sum;
+};
+
+void fib(int n, long *sum)
+{
+	if (n <= 2) {
+		*sum = 1;
+		return;
+	}
+
+	long x, y;
+	this_task::spawn(new(this_task::child<FibTask>()) FibTask(n - 1, &x));
+	this_task::call(new(this_task::child<FibTask>()) FibTask(n - 2, &y));
+
+	this_task::wait<FibTask>();
+
+	*sum = x + y;
+}
+
+TEST(this_task, fib) {
+	long answer = 0;
+
+	EXPECT_EQ(task<FibTask>::current(), nullptr);
+
+	{
+		scheduler<FibTask> sh(2, nthreads);
+		sh.spawn(new(sh.root()) FibTask(20, &answer));
+		sh.wait();
+	}
+
+	EXPECT_EQ(task<FibTask>::current(), nullptr);
+	EXPECT_EQ(answer, 6765);
+}
@@ -0,0 +1,85 @@
+#define STACCATO_TRACE 1
+#define STACCATO_TRACE_SIZE 1024
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+class FibTask: public task<FibTask>
+{
+public:
+	FibTask(int n, long *sum): n(n), sum(sum)
+	{ }
+
+	void execute() {
+		if (n <= 2) {
+			*sum = 1;
+			return;
+		}
+
+		long x, y;
+		spawn(new(child()) FibTask(n - 1, &x));
+		call(new(child()) FibTask(n - 2, &y));
+
+		wait();
+
+		*sum = x + y;
+	}
+
+private:
+	int n;
+	long *sum;
+};
+
+static size_t count(const std::string &s, const std::string &what)
+{
+	size_t n = 0;
+	for (auto p = s.find(what); p != std::string::npos; p = s.find(what, p + 1))
+		n++;
+	return n;
+}
+
+static std::string run_fib(int n)
+{
+	long answer = 0;
+
+	scheduler<FibTask> sh(2, nthreads);
+	sh.spawn(new(sh.root()) FibTask(n, &answer));
+	sh.wait();
+
+	std::ostringstream os;
+	sh.write_trace(os);
+	return os.str();
+}
+
+TEST(trace, small_tree) {
+	auto s = run_fib(8);
+
+	EXPECT_EQ(s.find("{\"traceEvents\":["), 0ul);
+	EXPECT_EQ(count(s, "\"thread_name\""), nthreads);
+
+	// fib(8) with the last child called inline runs 41 tasks
+	auto nbegin = count(s, "{\"name\":\"task\",\"ph\":\"B\"");
+	auto nend = count(s, "{\"name\":\"task\",\"ph\":\"E\"");
+	EXPECT_EQ(nbegin, 41ul);
+	EXPECT_EQ(nend, 41ul);
+}
+
+TEST(trace, ring_overflow) {
+	// Far more events than fit in the buffers, and no slice may end
+	// without its beginning
+	auto s = run_fib(20);
+
+	auto nbegin = count(s, "\"ph\":\"B\"");
+	auto nend = count(s, "\"ph\":\"E\"");
+	EXPECT_GE(nbegin, nend);
+	EXPECT_LE(nbegin, nthreads * 1024);
+}
@@ -0,0 +1,85 @@
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "worker_local.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+class CountTask: public task<CountTask>
+{
+public:
+	CountTask(worker_local<size_t> *counts, size_t n)
+	: counts(counts), n(n)
+	{ }
+
+	void execute() {
+		if (n <= 1) {
+			counts->local()++;
+			return;
+		}
+
+		spawn(new(child()) CountTask(counts, n / 2));
+		spawn(new(child()) CountTask(counts, n - n / 2));
+
+		wait();
+	}
+
+private:
+	worker_local<size_t> *counts;
+	size_t n;
+};
+
+TEST(worker_local, counts) {
+	size_t n = 100000;
+
+	scheduler<CountTask> sh(2, nthreads, 20);
+	worker_local<size_t> counts(sh);
+
+	EXPECT_TRUE(counts.empty());
+	EXPECT_TRUE(counts.begin() == counts.end());
+
+	sh.spawn(new(sh.root()) CountTask(&counts, n));
+	sh.wait();
+
+	EXPECT_GE(counts.size(), 1ul);
+	EXPECT_LE(counts.size(), nthreads);
+
+	size_t sum = 0;
+	size_t nvalues = 0;
+	for (auto c : counts) {
+		sum += c;
+		nvalues++;
+	}
+
+	EXPECT_EQ(sum, n);
+	EXPECT_EQ(nvalues, counts.size());
+
+	auto plus = [](size_t a, size_t b) { return a + b; };
+	EXPECT_EQ(counts.combine(0, plus), n);
+}
+
+TEST(worker_local, exemplar) {
+	scheduler<CountTask> sh(2, nthreads, 4);
+	worker_local<size_t> counts(sh, 10);
+
+	sh.spawn(new(sh.root()) CountTask(&counts, 1));
+	sh.wait();
+
+	ASSERT_EQ(counts.size(), 1ul);
+	EXPECT_EQ(*counts.begin(), 11ul);
+}
+
+TEST(worker_local, padded) {
+	scheduler<CountTask> sh(2, nthreads, 20);
+	worker_local<size_t> counts(sh);
+
+	sh.spawn(new(sh.root()) CountTask(&counts, 1000));
+	sh.wait();
+
+	for (auto &c : counts)
+		EXPECT_EQ(reinterpret_cast<uintptr_t>(&c) % STACCATO_CACHE_SIZE, 0ul);
+}
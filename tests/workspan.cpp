@@ -0,0 +1,135 @@
+#define STACCATO_WORKSPAN 1
+
+#include "gtest/gtest.h"
+
+#include "task.hpp"
+#include "scheduler.hpp"
+
+using namespace staccato;
+
+static const size_t nthreads = 4;
+
+class FibTask: public task<FibTask>
+{
+public:
+	FibTask(int n, long *sum): n(n), sum(sum)
+	{ }
+
+	void execute() {
+		if (n <= 2) {
+			*sum = 1;
+			return;
+		}
+
+		long x, y;
+		spawn(new(child()) FibTask(n - 1, &x));
+		call(new(child()) FibTask(n - 2, &y));
+
+		wait();
+
+		*sum = x + y;
+	}
+
+private:
+	int n;
+	long *sum;
+};
+
+// Busy loop of n iterations in every leaf of a tree of the given fanout
+class SpinTask: public task<SpinTask>
+{
+public:
+	SpinTask(int depth, size_t fanout, bool spawned)
+	: depth(depth), fanout(fanout), spawned(spawned)
+	{ }
+
+	void execute() {
+		if (depth == 0) {
+			volatile size_t x = 0;
+			for (size_t i = 0; i < 100000; ++i)
+				x = x + i;
+			return;
+		}
+
+		for (size_t i = 0; i < fanout; ++i) {
+			if (spawned) {
+				new(child(i)) SpinTask(depth - 1, fanout, spawned);
+			} else {
+				call(new(child()) SpinTask(depth - 1, fanout, spawned));
+			}
+		}
+
+		if (spawned) {
+			spawn_n(fanout);
+			wait();
+		}
+	}
+
+private:
+	int depth;
+	size_t fanout;
+	bool spawned;
+};
+
+TEST(workspan, serial_calls) {
+	scheduler<SpinTask> sh(4, nthreads);
+	sh.spawn(new(sh.root()) SpinTask(3, 4, false));
+	sh.wait();
+
+	auto ws = sh.workspans();
+	ASSERT_EQ(ws.size(), 1ul);
+
+	// Nothing is spawned below the root
+	EXPECT_GT(ws[0].work, 0ul);
+	EXPECT_EQ(ws[0].span, ws[0].work);
+	EXPECT_EQ(ws[0].burdened_span, ws[0].span);
+	EXPECT_DOUBLE_EQ(ws[0].parallelism(), 1.0);
+	EXPECT_DOUBLE_EQ(ws[0].speedup_upper_bound(nthreads), 1.0);
+}
+
+TEST(workspan, spawned_tree) {
+	// On one worker strands aren't preempted by other workers
+	scheduler<SpinTask> sh(4, 1);
+	sh.spawn(new(sh.root()) SpinTask(3, 4, true));
+	sh.wait();
+
+	auto ws = sh.workspans();
+	ASSERT_EQ(ws.size(), 1ul);
+
+	// Timings are noisy, but the other 63 leaves add to the work only and
+	// each of the 3 levels of spawns adds a burden
+	EXPECT_GT(ws[0].parallelism(), 1.0);
+
+	EXPECT_GE(ws[0].burdened_span, ws[0].span + 3 * STACCATO_WORKSPAN_BURDEN);
+	EXPECT_LT(ws[0].burdened_parallelism(), ws[0].parallelism());
+
+	EXPECT_LE(ws[0].speedup_upper_bound(nthreads), double(nthreads));
+	EXPECT_LT(ws[0].speedup_lower_bound(nthreads), ws[0].speedup_upper_bound(nthreads));
+}
+
+TEST(workspan, roots_in_order) {
+	scheduler<FibTask> sh(2, nthreads);
+
+	long small = 0, large = 0;
+
+	sh.spawn(new(sh.root()) FibTask(10, &small));
+	sh.wait();
+
+	sh.spawn(new(sh.root()) FibTask(20, &large));
+	sh.wait();
+
+	EXPECT_EQ(small, 55);
+	EXPECT_EQ(large, 6765);
+
+	auto ws = sh.workspans();
+	ASSERT_EQ(ws.size(), 2ul);
+
+	for (auto &w : ws) {
+		EXPECT_GE(w.work, w.span);
+		EXPECT_GE(w.burdened_span, w.span);
+	}
+
+	// Chains of 8 and 18 spawns
+	EXPECT_GE(ws[0].burdened_span, 8 * STACCATO_WORKSPAN_BURDEN);
+	EXPECT_GE(ws[1].burdened_span, 18 * STACCATO_WORKSPAN_BURDEN);
+}